@@ -1,9 +1,21 @@
 """
 Plot script for bilayer stats 
 """
+import os
 import numpy as np
 import matplotlib.pyplot as plt
 
+def ringdist(basename):
+    """
+    Size and area of every ring, mapped from the .npy arrays of a run
+    with npy, else read from ringdist.dat 
+    """
+    if os.path.exists(basename+"ringsize.npy"):
+        return (np.load(basename+"ringsize.npy",mmap_mode='r'),
+                np.load(basename+"ringarea.npy",mmap_mode='r'))
+    data = np.loadtxt(basename+"ringdist.dat",ndmin=2)
+    return data[:,0].astype(int), data[:,1]
+
 def ringhistogram():
     """
     Create ringhistogram
@@ -222,19 +234,7 @@ def nringarea(ringsize,ringarea,ring):
 
 def plotareahists(basename): 
     
-    #open the file 
-    ringsize = []
-    ringarea = []
-    ring = open(basename+"ringdist.dat","r")
-    
-    for line in ring:
-        ringsize.append( line.strip('\n').split()[0] )
-        ringarea.append( line.strip('\n').split()[1] )
-
-    ring.close()
-
-    ringsize = np.array(ringsize,dtype=int)
-    ringarea = np.array(ringarea,dtype=float)
+    ringsize, ringarea = ringdist(basename)
 
     ring = 4
     binsize=[10,15,15,15,15,9]
@@ -263,7 +263,7 @@ def plotareahists(basename):
 
 
 def PlotAboav(basename):
-    file = open("ABOAV.dat","r")
+    file = open(basename+"ABOAV.dat","r")
     ringsize = []
     aring = []
 
@@ -4,9 +4,11 @@ Calculates moments of ring distribution from
 the ring distribution file. 
 
 ./moment FILES 
-FILE:    ._ringdist.dat FILE
+FILE:    ._ringdist.dat FILE, the ring sizes are mapped from the
+         _ringsize.npy next to it when a run with npy wrote one 
 """
 
+import os
 import sys
 import numpy as np 
 
@@ -20,11 +22,16 @@ def main(verbose=False):
     
     for network in sys.argv[1:]:
         maxring=11
-        countBucket=np.zeros(maxring)
-        infile = open(network,"r")
-        for line in infile:
-            countBucket[int(line.strip('\n').split()[0])] += 1
-        infile.close()
+        npyfile = network.replace("_ringdist.dat","_ringsize.npy")
+        if network.endswith("_ringdist.dat") and os.path.exists(npyfile):
+            sizes = np.load(npyfile,mmap_mode='r')
+            countBucket = np.bincount(sizes,minlength=maxring).astype(float)
+        else:
+            countBucket=np.zeros(maxring)
+            infile = open(network,"r")
+            for line in infile:
+                countBucket[int(line.strip('\n').split()[0])] += 1
+            infile.close()
         
         total=countBucket.sum()
         avg=0.0 
@@ -6,10 +6,11 @@ Plot the ringhistogram graph.
 
 RINGHIST:    Ringhist file
 AREAHIST:    Areahist file     
-BONDLENGTH:  Bondlengths 
+BONDLENGTH:  Bondlengths, or the _bondlength.npy of a run with npy 
 
 """
 
+import os
 import numpy as np 
 import matplotlib.pyplot as plt
 import sys 
@@ -111,8 +112,13 @@ def bondlength(filename):
     
     bondlength(filename):
     
-    filename: file with bond lengths
+    filename: file with bond lengths, mapped from the .npy file of the
+    same name when there is one 
     """
+    npyfile = os.path.splitext(filename)[0]+".npy"
+    if os.path.exists(npyfile):
+        bonds = np.load(npyfile,mmap_mode='r')
+        return bonds.mean(), bonds.std()
     bonds = []
     infile = open(filename,"r")
     for line in infile:
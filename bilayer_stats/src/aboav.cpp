@@ -6,11 +6,20 @@
 
 #include "vertex.h"
 #include "graph.h"
+#include "aboav.h"
+#include "asyncwriter.h"
+#include "stages.h"
+#include "log.h"
 
-void aboavDiagnostic(std::vector<Vertex*> &iCycle, std::vector<vector <Vertex*> > &pairs, std::vector<vector<Vertex*> > &rings)
+void aboavDiagnostic(std::vector<Vertex*> &iCycle, std::vector<vector <Vertex*> > &pairs, std::vector<vector<Vertex*> > &rings, string nfile)
 {
   FILE* out; 
-  out = fopen("aboavDiagnostic.dat","w"); 
+  out = outputOpen(nfile+"_aboavDiagnostic.dat"); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write" << std::endl; 
+      return; 
+    }
   fprintf(out, "#Ring Coordinates\n"); 
   for(unsigned int i =0; i < iCycle.size(); i++)
     {
@@ -43,7 +52,7 @@ void aboavDiagnostic(std::vector<Vertex*> &iCycle, std::vector<vector <Vertex*>
 	}//i loop over the rings 
       fprintf(out,"\n"); 
     }
-  fclose(out); 
+  outputClose(out); 
 }//aboavDiagnostic()
 
 /**
@@ -93,6 +102,8 @@ double aboavAverage(std::vector <std::vector<Vertex*> > &rings)
 {
   double sum=0.0;  
   double Nrings = rings.size(); 
+  if(rings.empty())   //a ring without neighbors has no average 
+    return 0.0; 
   for(unsigned int i =0; i < rings.size(); i++)
     {
       sum+=rings[i].size(); 
@@ -125,7 +136,7 @@ std::vector <double> globalAboav(std::vector<std::vector<double> > &aboavStack,
   for(int i =0; i < ringmax; i++) aboavfunction.push_back(0); //12 
     
   double sum, counter;  
-  for(unsigned int i =0; i < aboavStack[0].size(); i++)
+  for(unsigned int i =0; i < aboavfunction.size(); i++)
     {
       sum = 0; 
       counter =0; 
@@ -154,10 +165,15 @@ std::vector <double> globalAboav(std::vector<std::vector<double> > &aboavStack,
  AboavStack Dump into a file 
  @param aboavStack contains all the info 
  */
-void AboavStackDump(std::vector<std::vector <double> > &aboavStack)
+void AboavStackDump(std::vector<std::vector <double> > &aboavStack, string nfile)
 {
   FILE* out; 
-  out = fopen("AboavStack.dat","w"); 
+  out = outputOpen(nfile+"_AboavStack.dat"); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write" << std::endl; 
+      return; 
+    }
   for(unsigned int i =0; i < aboavStack.size(); i++)
     {
       for(unsigned int j =0; j < aboavStack[i].size(); j++)
@@ -166,7 +182,7 @@ void AboavStackDump(std::vector<std::vector <double> > &aboavStack)
 	}
       fprintf(out,"\n"); 
     }
-  fclose(out); 
+  outputClose(out); 
 }
 
 
@@ -231,8 +247,9 @@ std::vector <std::vector <Vertex*> > findEdges(std::vector <Vertex*> &ring)
 
 /**
    Calculates the Aboav function 
+   @param outputs, requested outputs, only the requested Aboav files are written
  */
-void Aboav(std::vector<std::vector <Vertex*> > &allCycles, double aboavBucket [],std::vector<std::vector<double> > &aboavStack, int ringmax)
+void Aboav(std::vector<std::vector <Vertex*> > &allCycles, double aboavBucket [],std::vector<std::vector<double> > &aboavStack, int ringmax, unsigned int outputs, string nfile)
 {
   double average; //value;  
   std::vector <Vertex*> iCycle; 
@@ -244,7 +261,8 @@ void Aboav(std::vector<std::vector <Vertex*> > &allCycles, double aboavBucket []
       pairs = findEdges(iCycle); 
       //Now find the other rings in the pairs 
       rings = sideRings(pairs, iCycle); 
-      aboavDiagnostic(iCycle, pairs, rings); 
+      if(hasOutput(outputs,OUT_ABOAVDIAGNOSTIC))
+	aboavDiagnostic(iCycle, pairs, rings, nfile); 
        //Calculate Average 
       average = aboavAverage(rings);
       fillAboavBucket(aboavBucket, average, iCycle,aboavStack,ringmax);
@@ -253,20 +271,28 @@ void Aboav(std::vector<std::vector <Vertex*> > &allCycles, double aboavBucket []
       rings.clear(); 
     }
   std::vector <double> aboavfunction = globalAboav(aboavStack,ringmax); 
-  AboavStackDump(aboavStack); 
+  if(hasOutput(outputs,OUT_ABOAVSTACK))
+    AboavStackDump(aboavStack, nfile); 
   
   for(unsigned int i =0; i < aboavfunction.size(); i++)
     {
-      std::cout << i << "   " <<  aboavfunction[i]  << std::endl; 
+      LOG(LOG_DEBUG) << i << "   " <<  aboavfunction[i]  << std::endl; 
     }
  
+  if(!hasOutput(outputs,OUT_ABOAV))
+    return; 
   FILE* ringAvg; 
-  ringAvg = fopen("ABOAV.dat","w"); 
+  ringAvg = outputOpen(nfile+"_ABOAV.dat"); 
+  if(ringAvg == NULL)
+    {
+      std::cerr << "Cannot open file for write" << std::endl; 
+      return; 
+    }
   for(unsigned int i =0; i < aboavfunction.size(); i++)
     {
       fprintf(ringAvg, "%d  %f\n", i, aboavfunction[i]); 
     }
-  fclose(ringAvg); 
+  outputClose(ringAvg); 
 }
 
 
@@ -0,0 +1,193 @@
+//asyncwriter.cpp
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <string>
+#include <pthread.h>
+
+#include "asyncwriter.h"
+
+/*
+  A file collected in memory, from outputOpen to outputClose
+ */
+struct MemoryFile
+{
+  string file;
+  char *data;
+  size_t size;
+};
+
+/*
+  State of the writer thread, the open memory files and the queue of
+  closed files still to be written
+ */
+struct OutputQueue
+{
+  pthread_mutex_t lock;
+  pthread_cond_t ready;      //a file was queued
+  pthread_cond_t written;    //a file was written
+  bool started;
+  std::map<FILE*,MemoryFile*> open;
+  std::deque<MemoryFile> queue;
+  size_t queued;             //bytes in the queue
+  size_t limit;
+  int failed;                //files that could not be written since the last flush
+  unsigned long nclosed;     //files queued so far
+  unsigned long nwritten;    //files written so far, in the order they were queued
+};
+
+static OutputQueue output = {PTHREAD_MUTEX_INITIALIZER,PTHREAD_COND_INITIALIZER,PTHREAD_COND_INITIALIZER,
+			     false,std::map<FILE*,MemoryFile*>(),std::deque<MemoryFile>(),0,(size_t)1 << 28,0,0,0};
+
+/*
+  outputWriter, the writer thread, writes the queued files in order
+ */
+void* outputWriter(void*)
+{
+  while(true)
+    {
+      pthread_mutex_lock(&output.lock);
+      while(output.queue.empty())
+	pthread_cond_wait(&output.ready,&output.lock);
+      MemoryFile job = output.queue.front();
+      pthread_mutex_unlock(&output.lock);
+
+      bool ok = false;
+      FILE *out = fopen(job.file.c_str(),"wb");
+      if(out != NULL)
+	{
+	  ok = fwrite(job.data,1,job.size,out) == job.size;
+	  ok = fclose(out) == 0 && ok;
+	}
+      if(!ok)
+	std::cerr << "Cannot write file: " << job.file << std::endl;
+      free(job.data);
+
+      pthread_mutex_lock(&output.lock);
+      output.queue.pop_front();
+      output.queued -= job.size;
+      output.nwritten++;
+      if(!ok)
+	output.failed++;
+      pthread_cond_broadcast(&output.written);
+      pthread_mutex_unlock(&output.lock);
+    }
+  return NULL;
+}//outputWriter()
+
+/*
+  outputOpen, opens an output file collected in memory. Falls back to
+  the file itself when memory streams are not available.
+  @param file, name of the output file
+  @return the stream to write to, NULL if it could not be opened
+*/
+FILE* outputOpen(string file)
+{
+  //the stream updates data and size in place, they must outlive this call
+  MemoryFile *mem = new MemoryFile;
+  mem->file = file;
+  mem->data = NULL;
+  mem->size = 0;
+  FILE *out = open_memstream(&mem->data,&mem->size);
+  if(out == NULL)
+    {
+      delete mem;
+      return fopen(file.c_str(),"wb");
+    }
+
+  pthread_mutex_lock(&output.lock);
+  if(!output.started)
+    {
+      pthread_t thread;
+      if(pthread_create(&thread,NULL,outputWriter,NULL) == 0)
+	{
+	  pthread_detach(thread);
+	  output.started = true;
+	}
+    }
+  if(!output.started)
+    {
+      pthread_mutex_unlock(&output.lock);
+      fclose(out);
+      free(mem->data);
+      delete mem;
+      return fopen(file.c_str(),"wb");
+    }
+  output.open[out] = mem;
+  pthread_mutex_unlock(&output.lock);
+  return out;
+}//outputOpen()
+
+/*
+  outputClose, closes a stream of outputOpen and queues its file for
+  writing. Waits while the queue holds more than its limit, a single
+  file larger than the limit waits for an empty queue.
+  @param out, stream of outputOpen
+  @return 0, -1 if the stream could not be closed
+*/
+int outputClose(FILE *out)
+{
+  pthread_mutex_lock(&output.lock);
+  std::map<FILE*,MemoryFile*>::iterator it = output.open.find(out);
+  if(it == output.open.end())
+    {
+      pthread_mutex_unlock(&output.lock);
+      return fclose(out) == 0 ? 0 : -1;
+    }
+  MemoryFile *mem = it->second;
+  output.open.erase(it);
+  pthread_mutex_unlock(&output.lock);
+
+  //data and size are final once the stream is closed
+  bool error = ferror(out) != 0;
+  if(fclose(out) != 0 || error)
+    {
+      std::cerr << "Cannot write file: " << mem->file << std::endl;
+      free(mem->data);
+      delete mem;
+      return -1;
+    }
+
+  pthread_mutex_lock(&output.lock);
+  while(!output.queue.empty() && output.queued + mem->size > output.limit)
+    pthread_cond_wait(&output.written,&output.lock);
+  output.queue.push_back(*mem);
+  output.queued += mem->size;
+  output.nclosed++;
+  pthread_cond_signal(&output.ready);
+  pthread_mutex_unlock(&output.lock);
+  delete mem;
+  return 0;
+}//outputClose()
+
+/*
+  outputFlush, waits until every closed output file is written
+  @return 0, -1 if a file failed to be written since the last flush
+*/
+int outputFlush()
+{
+  pthread_mutex_lock(&output.lock);
+  while(!output.queue.empty())
+    pthread_cond_wait(&output.written,&output.lock);
+  int failed = output.failed;
+  output.failed = 0;
+  pthread_mutex_unlock(&output.lock);
+  return failed ? -1 : 0;
+}//outputFlush()
+
+/*
+  outputSync, waits until the files closed before the call are written,
+  not for the files other threads close meanwhile. The failures are
+  left for outputFlush to report.
+*/
+void outputSync()
+{
+  pthread_mutex_lock(&output.lock);
+  unsigned long target = output.nclosed;
+  while(output.nwritten < target)
+    pthread_cond_wait(&output.written,&output.lock);
+  pthread_mutex_unlock(&output.lock);
+}//outputSync()
+
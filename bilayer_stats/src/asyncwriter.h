@@ -0,0 +1,23 @@
+//asyncwriter.h 
+#ifndef _ASYNCWRITER_H
+#define _ASYNCWRITER_H
+
+#include <cstdio>
+#include <string>
+
+using namespace std; 
+
+/*
+  Output files written behind the analysis. outputOpen gives a FILE*
+  that collects the file in memory, outputClose hands it to a writer
+  thread which does the file system calls, so the analysis only waits
+  when more than the queue limit is still unwritten. outputFlush waits
+  until every closed file is on disk, outputSync until the files closed
+  before it are. 
+ */
+FILE* outputOpen(string file); 
+int outputClose(FILE *out); 
+int outputFlush(); 
+void outputSync(); 
+
+#endif 
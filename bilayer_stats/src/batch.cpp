@@ -0,0 +1,188 @@
+//batch.cpp 
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "sample.h"
+#include "batch.h"
+#include "asyncwriter.h"
+#include "threadbudget.h"
+#include "log.h"
+
+/*
+  Work shared by the threads of the pool. Each thread takes the next
+  sample from the manifest until none are left. The pool holds threads
+  of the budget, each thread that runs out of samples gives one back
+  to the samples still running. 
+ */
+struct BatchQueue
+{
+  std::vector<BatchEntry> *entries; 
+  std::vector<SampleSummary> *summaries; 
+  unsigned int next; 
+  int held; 
+  pthread_mutex_t lock; 
+};
+
+/*
+  readManifest, reads a manifest with one sample per line. Blank lines
+  and lines starting with # are skipped. 
+  @param file, manifest file 
+  @param entries, filled with the samples 
+  @return 0 on success, -1 if the manifest could not be read 
+*/
+int readManifest(const char *file, std::vector<BatchEntry> &entries)
+{
+  FILE *in; 
+  char line[4096]; 
+  char xyz[1024], xml[1024], con[1024]; 
+  int nline = 0; 
+
+  in = fopen(file,"r"); 
+  if(in == NULL)
+    {
+      std::cerr << "Cannot open file: " << file << std::endl; 
+      return -1; 
+    }
+  while(fgets(line,sizeof(line),in))
+    {
+      nline++; 
+      int nread = sscanf(line,"%1023s %1023s %1023s",xyz,xml,con); 
+      if(nread <= 0 || xyz[0] == '#')
+	continue; 
+      if(nread < 2)
+	{
+	  std::cerr << "Manifest line " << nline << " needs an xyz and an xml file" << std::endl; 
+	  fclose(in); 
+	  return -1; 
+	}
+      BatchEntry entry; 
+      entry.xyzfile = xyz; 
+      entry.xmlfile = xml; 
+      if(nread == 3)
+	entry.confile = con; 
+      entries.push_back(entry); 
+    }
+  fclose(in); 
+  return 0; 
+}//readManifest()
+
+/*
+  batchWorker, thread of the pool. A failing sample only marks its own
+  summary as failed. 
+ */
+void* batchWorker(void *arg)
+{
+  BatchQueue *queue = (BatchQueue*)arg; 
+  while(true)
+    {
+      pthread_mutex_lock(&queue->lock); 
+      unsigned int i = queue->next++; 
+      if(i >= queue->entries->size() && queue->held > 0)
+	{
+	  queue->held--; 
+	  threadsRelease(1); 
+	}
+      pthread_mutex_unlock(&queue->lock); 
+      if(i >= queue->entries->size())
+	break; 
+
+      BatchEntry &entry = (*queue->entries)[i]; 
+      SampleSummary &summary = (*queue->summaries)[i]; 
+      const char *con = entry.confile.empty() ? NULL : entry.confile.c_str(); 
+      if(analyzeSample(entry.xyzfile.c_str(),entry.xmlfile.c_str(),con,summary) != 0)
+	std::cerr << "Sample " << entry.xyzfile << " failed: " << summary.error << std::endl; 
+      //the files of a finished sample are on disk before the next sample
+      //starts, a crash only loses the samples in progress 
+      outputSync(); 
+    }
+  return NULL; 
+}//batchWorker()
+
+/*
+  batchSummaryOut, combined table of the statistics of all samples 
+  @param entries, samples of the manifest
+  @param summaries, statistics of the samples
+  @param nfile, output file 
+*/
+void batchSummaryOut(std::vector<BatchEntry> &entries, std::vector<SampleSummary> &summaries, string nfile)
+{
+  FILE *out; 
+  out = outputOpen(nfile); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write: " << nfile << std::endl; 
+      return; 
+    }
+  fprintf(out,"#xyz basename status atoms bonds rings average mu2 bondlength deviation area/bondlength^2 lewis alpha\n"); 
+  for(unsigned int i = 0; i < summaries.size(); i++)
+    {
+      if(summaries[i].status != 0)
+	{
+	  fprintf(out,"%s %s FAILED %d 0 0 0 0 0 0 0 0 0 #%s\n",entries[i].xyzfile.c_str(),
+		  summaries[i].basename.empty() ? "-" : summaries[i].basename.c_str(),
+		  summaries[i].natoms,summaries[i].error.c_str()); 
+	  continue; 
+	}
+      fprintf(out,"%s %s OK %d %d %d %f %f %f %f %f %f %f\n",entries[i].xyzfile.c_str(),summaries[i].basename.c_str(),
+	      summaries[i].natoms,summaries[i].nbonds,summaries[i].nrings,summaries[i].average,
+	      summaries[i].mu2,summaries[i].bndlength,summaries[i].deviation,summaries[i].arealength,
+	      summaries[i].lewis,summaries[i].alpha); 
+    }
+  outputClose(out); 
+}//batchSummaryOut()
+
+/*
+  runBatch, analyzes all of the samples of a manifest on a pool of threads 
+  @param manifest, file with one line of xyz xml [con] per sample 
+  @param nthreads, size of the pool, the number of cores if not positive
+  @return 0 if every sample succeeded, 1 otherwise 
+*/
+int runBatch(const char *manifest, int nthreads)
+{
+  std::vector<BatchEntry> entries; 
+  if(readManifest(manifest,entries) != 0)
+    return 1; 
+  if(nthreads <= 0)
+    nthreads = sysconf(_SC_NPROCESSORS_ONLN); 
+  if(nthreads > (int)entries.size())
+    nthreads = entries.size(); 
+  if(nthreads < 1)
+    nthreads = 1; 
+  LOG(LOG_INFO) << "Batch of " << entries.size() << " samples on " << nthreads << " threads" << std::endl; 
+
+  std::vector<SampleSummary> summaries(entries.size()); 
+  BatchQueue queue; 
+  queue.entries = &entries; 
+  queue.summaries = &summaries; 
+  queue.next = 0; 
+  //the main thread waits, its place goes to one of the pool 
+  queue.held = threadsAcquire(nthreads - 1); 
+  pthread_mutex_init(&queue.lock,NULL); 
+
+  std::vector<pthread_t> threads(nthreads); 
+  for(int i = 0; i < nthreads; i++)
+    pthread_create(&threads[i],NULL,batchWorker,&queue); 
+  for(int i = 0; i < nthreads; i++)
+    pthread_join(threads[i],NULL); 
+  threadsRelease(queue.held); 
+  pthread_mutex_destroy(&queue.lock); 
+
+  string nfile = manifest; 
+  if(nfile.find_last_of('.') != string::npos && nfile.find_last_of('.') > nfile.find_last_of('/') + 1)
+    nfile = nfile.substr(0,nfile.find_last_of('.')); 
+  nfile += "_summary.dat"; 
+  batchSummaryOut(entries,summaries,nfile); 
+
+  int nfailed = 0; 
+  for(unsigned int i = 0; i < summaries.size(); i++)
+    if(summaries[i].status != 0)
+      nfailed++; 
+  LOG(LOG_INFO) << "Batch finished: " << entries.size() - nfailed << " succeeded, " << nfailed << " failed" << std::endl; 
+  LOG(LOG_INFO) << "Summary: " << nfile << std::endl; 
+  return nfailed ? 1 : 0; 
+}//runBatch()
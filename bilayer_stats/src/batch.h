@@ -0,0 +1,24 @@
+//batch.h 
+#ifndef _BATCH_H
+#define _BATCH_H
+
+#include <string>
+#include <vector>
+
+#include "sample.h"
+
+/*
+  One line of a batch manifest: xyz xml [con]
+ */
+struct BatchEntry
+{
+  string xyzfile; 
+  string xmlfile; 
+  string confile; 
+};
+
+int readManifest(const char *file, std::vector<BatchEntry> &entries); 
+void batchSummaryOut(std::vector<BatchEntry> &entries, std::vector<SampleSummary> &summaries, string nfile); 
+int runBatch(const char *manifest, int nthreads); 
+
+#endif 
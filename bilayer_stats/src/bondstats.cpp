@@ -0,0 +1,164 @@
+//bondstats.cpp 
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#define BONDSTATS_X86
+#include <immintrin.h>
+#endif
+
+#include "vertex.h"
+#include "graph.h"
+#include "bondstats.h"
+#include "asyncwriter.h"
+
+#ifdef BONDSTATS_X86
+/*
+  bondLengthsAvx2, the lengths of the bond vectors eight at a time, for
+  processors with AVX2 
+  @return number of bonds done, a multiple of eight 
+*/
+__attribute__((target("avx2")))
+static int bondLengthsAvx2(const float *dx, const float *dy, const float *dz, float *length, int n)
+{
+  int k = 0; 
+  for(; k + 8 <= n; k += 8)
+    {
+      __m256 x = _mm256_loadu_ps(dx + k); 
+      __m256 y = _mm256_loadu_ps(dy + k); 
+      __m256 z = _mm256_loadu_ps(dz + k); 
+      __m256 r2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x,x),_mm256_mul_ps(y,y)),_mm256_mul_ps(z,z)); 
+      _mm256_storeu_ps(length + k,_mm256_sqrt_ps(r2)); 
+    }
+  return k; 
+}//bondLengthsAvx2()
+
+static bool cpuAvx2()
+{
+  __builtin_cpu_init(); 
+  return __builtin_cpu_supports("avx2"); 
+}//cpuAvx2()
+
+static const bool hasAvx2 = cpuAvx2(); 
+#endif
+
+/*
+  bondStatistics, mean, variance, range and histogram of the bond
+  lengths in a single pass over the unique edges. The bond vectors use
+  the periodic image stored with each edge. Edges to other layers are
+  left out. 
+  @param vertices, vertices of the sample or of a layer 
+  @param cell, periodic cell 
+  @param stats, filled with the statistics and the length of each bond
+  @param nbins, number of bins of the histogram between min and max
+*/
+void bondStatistics(std::vector<Vertex*> &vertices, const Cell &cell, BondStats &stats, int nbins)
+{
+  std::vector<float> dx, dy, dz; 
+  stats.first.clear(); 
+  stats.second.clear(); 
+
+  //gather each edge once 
+  for(unsigned int i = 0; i < vertices.size(); i++)
+    {
+      Vertex *v = vertices[i]; 
+      for(unsigned int j = 0; j < v->edges.size(); j++)
+	{
+	  if(v->edges[j]->index < v->index || v->edges[j]->layer != v->layer)
+	    continue; 
+	  float xij, yij, zij; 
+	  v->BondVector(j,cell,xij,yij,zij); 
+	  dx.push_back(xij); 
+	  dy.push_back(yij); 
+	  dz.push_back(zij); 
+	  stats.first.push_back(v->index); 
+	  stats.second.push_back(v->edges[j]->index); 
+	}
+    }
+
+  int n = dx.size(); 
+  stats.nbonds = n; 
+  stats.length.resize(n); 
+  int k = 0; 
+#ifdef BONDSTATS_X86
+  if(hasAvx2 && n > 0)
+    k = bondLengthsAvx2(&dx[0],&dy[0],&dz[0],&stats.length[0],n); 
+#endif
+  for(; k < n; k++)
+    stats.length[k] = std::sqrt(dx[k]*dx[k] + dy[k]*dy[k] + dz[k]*dz[k]); 
+
+  stats.mean = 0.0; 
+  stats.m2 = 0.0; 
+  stats.min = n ? stats.length[0] : 0.0; 
+  stats.max = stats.min; 
+  for(k = 0; k < n; k++)
+    {
+      double r = stats.length[k]; 
+      double delta = r - stats.mean; 
+      stats.mean += delta/(k+1); 
+      stats.m2 += delta*(r - stats.mean); 
+      if(stats.length[k] < stats.min) stats.min = stats.length[k]; 
+      if(stats.length[k] > stats.max) stats.max = stats.length[k]; 
+    }
+
+  stats.histogram.assign(nbins,0); 
+  stats.binwidth = (stats.max - stats.min)/nbins; 
+  for(k = 0; k < n; k++)
+    {
+      int bin = stats.binwidth > 0 ? (int)((stats.length[k] - stats.min)/stats.binwidth) : 0; 
+      if(bin >= nbins) bin = nbins - 1; 
+      stats.histogram[bin]++; 
+    }
+}//bondStatistics()
+
+/*
+  bondhistOut, outputs the bond statistics and histogram. The first
+  line is the mean, deviation, min and max, then the center and count
+  of each bin. 
+*/
+void bondhistOut(BondStats &stats, string nfile)
+{
+  FILE *out; 
+  out = outputOpen(nfile+"_bondhist.dat"); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write" << std::endl; 
+      return; 
+    }
+  fprintf(out,"%f %f %f %f\n",stats.mean,std::sqrt(stats.variance()),stats.min,stats.max); 
+  for(unsigned int i = 0; i < stats.histogram.size(); i++)
+    fprintf(out,"%f %d\n",stats.min + (i+0.5)*stats.binwidth,stats.histogram[i]); 
+  outputClose(out); 
+}//bondhistOut()
+
+/*
+  bondDump, binary dump of every bond: the number of bonds as an int
+  followed by a record of int first, int second, float length per bond
+*/
+void bondDump(BondStats &stats, string nfile)
+{
+  FILE *out; 
+  out = outputOpen(nfile+"_bondlength.bin"); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write" << std::endl; 
+      return; 
+    }
+  struct { int first; int second; float length; } record; 
+  std::vector<char> buffer(sizeof(int) + stats.nbonds*sizeof(record)); 
+  char *p = &buffer[0]; 
+  memcpy(p,&stats.nbonds,sizeof(int)); 
+  p += sizeof(int); 
+  for(int k = 0; k < stats.nbonds; k++)
+    {
+      record.first = stats.first[k]; 
+      record.second = stats.second[k]; 
+      record.length = stats.length[k]; 
+      memcpy(p,&record,sizeof(record)); 
+      p += sizeof(record); 
+    }
+  fwrite(&buffer[0],1,buffer.size(),out); 
+  outputClose(out); 
+}//bondDump()
@@ -0,0 +1,34 @@
+//bondstats.h 
+#ifndef _BONDSTATS_H
+#define _BONDSTATS_H
+
+#include <vector>
+#include <string>
+
+#include "graph.h"
+#include "cell.h"
+
+/*
+  Statistics of the bond lengths, each bond counted once 
+ */
+struct BondStats
+{
+  int nbonds; 
+  double mean; 
+  double m2;               //sum of squared deviations from the mean (Welford)
+  float min; 
+  float max; 
+  float binwidth; 
+  std::vector<int> histogram; 
+  std::vector<int> first;  //vertices of each bond 
+  std::vector<int> second; 
+  std::vector<float> length; 
+  BondStats() : nbonds(0), mean(0), m2(0), min(0), max(0), binwidth(0) {}
+  double variance() const { return nbonds ? m2/nbonds : 0.0; }
+};
+
+void bondStatistics(std::vector<Vertex*> &vertices, const Cell &cell, BondStats &stats, int nbins=100); 
+void bondhistOut(BondStats &stats, string nfile="bilayer"); 
+void bondDump(BondStats &stats, string nfile="bilayer"); 
+
+#endif 
@@ -0,0 +1,172 @@
+//bridges.cpp 
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+
+#include "vertex.h"
+#include "graph.h"
+#include "celllist.h"
+#include "bridges.h"
+#include "asyncwriter.h"
+#include "log.h"
+
+/*
+  contractBridges, replaces every Si-O-Si bridge of a full-atom sample
+  by a Si-Si edge that keeps the bridging oxygen. Oxygens already bonded
+  by a connectivity file keep their bonds, the others are bonded to the
+  silicons within the cutoff found with a cell list. An oxygen with
+  exactly two silicons is a bridge, the rest are non-bridging. The
+  oxygens leave the vertex list and are kept in the bridges of the graph. 
+  @param bilayer, graph, only silicons are left in the vertices 
+  @param cutoff, largest Si-O bond length 
+  @param cell, periodic cell 
+  @return the number of bridges 
+*/
+int contractBridges(Graph &bilayer, float cutoff, const Cell &cell)
+{
+  std::vector<Vertex*> silicons, oxygens; 
+  for(unsigned int i = 0; i < bilayer.vertices.size(); i++)
+    {
+      if(bilayer.vertices[i]->atomno == 8)
+	oxygens.push_back(bilayer.vertices[i]); 
+      else
+	silicons.push_back(bilayer.vertices[i]); 
+    }
+  if(oxygens.empty())
+    return 0; 
+
+  CellList cells; 
+  buildCellList(silicons,cutoff,cell,cells); 
+  std::vector<Vertex*> near; 
+  std::vector<int> coordination(4,0); 
+  int nbridges = 0; 
+  for(unsigned int i = 0; i < oxygens.size(); i++)
+    {
+      Vertex *o = oxygens[i]; 
+      near.clear(); 
+      for(unsigned int j = 0; j < o->edges.size(); j++)
+	if(o->edges[j]->atomno != 8)
+	  near.push_back(o->edges[j]); 
+      if(o->edges.empty())
+	cellNeighbors(cells,o->x,o->y,o->z,near); 
+      while(!o->edges.empty())
+	o->RemoveEdge(o->edges[0]); 
+
+      coordination[near.size() < 3 ? (int)near.size() : 3]++; 
+      if(near.size() != 2)
+	continue; 
+      //image of the second silicon through the oxygen 
+      Image image = near[0]->MinimumImage(o,cell) + o->MinimumImage(near[1],cell); 
+      near[0]->AddEdge(near[1],image,o); 
+      nbridges++; 
+    }
+  bilayer.vertices = silicons; 
+  bilayer.bridges.insert(bilayer.bridges.end(),oxygens.begin(),oxygens.end()); 
+
+  LOG(LOG_INFO) << "Contracted " << nbridges << " Si-O-Si bridges, oxygens with 0/1/2/3+ silicons: " 
+	    << coordination[0] << " " << coordination[1] << " " << coordination[2] << " " 
+	    << coordination[3] << std::endl; 
+  return nbridges; 
+}//contractBridges()
+
+/*
+  Orders vertices by index 
+ */
+bool lowerIndex(const Vertex *a, const Vertex *b)
+{
+  return a->index < b->index; 
+}
+
+/*
+  connectSi2O, Si-O bonds of a full-atom sample, every oxygen within the
+  cutoff of a silicon, found with a cell list over the oxygens. The
+  oxygens are those of the vertex list and those contracted into bridges. 
+  @param bilayer, graph 
+  @param cutoff, largest Si-O bond length 
+  @param cell, periodic cell 
+  @param silicon, oxygen, index of the atoms of each bond, ordered by
+  silicon then oxygen 
+*/
+void connectSi2O(Graph &bilayer, float cutoff, const Cell &cell, std::vector<int> &silicon, std::vector<int> &oxygen)
+{
+  std::vector<Vertex*> silicons, oxygens = bilayer.bridges; 
+  for(unsigned int i = 0; i < bilayer.vertices.size(); i++)
+    {
+      if(bilayer.vertices[i]->atomno == 8)
+	oxygens.push_back(bilayer.vertices[i]); 
+      else
+	silicons.push_back(bilayer.vertices[i]); 
+    }
+  std::sort(silicons.begin(),silicons.end(),lowerIndex); 
+  silicon.clear(); 
+  oxygen.clear(); 
+  if(oxygens.empty())
+    return; 
+
+  CellList cells; 
+  buildCellList(oxygens,cutoff,cell,cells); 
+  std::vector<Vertex*> near; 
+  for(unsigned int i = 0; i < silicons.size(); i++)
+    {
+      cellNeighbors(cells,silicons[i]->x,silicons[i]->y,silicons[i]->z,near); 
+      std::sort(near.begin(),near.end(),lowerIndex); 
+      for(unsigned int j = 0; j < near.size(); j++)
+	{
+	  silicon.push_back(silicons[i]->index); 
+	  oxygen.push_back(near[j]->index); 
+	}
+    }
+}//connectSi2O()
+
+/*
+  siOxygenOut, Si-O connectivity table in the format of the connectivity
+  input, the number of bonds and then one bond per line 
+  @param silicon, oxygen, the bonds 
+  @param nfile, basename of the output file 
+*/
+void siOxygenOut(std::vector<int> &silicon, std::vector<int> &oxygen, string nfile)
+{
+  FILE *out; 
+  out = outputOpen(nfile+"_SiO.con"); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write" << std::endl; 
+      return; 
+    }
+  fprintf(out,"%d\n",(int)silicon.size()); 
+  for(unsigned int i = 0; i < silicon.size(); i++)
+    fprintf(out,"%d %d\n",silicon[i],oxygen[i]); 
+  outputClose(out); 
+}//siOxygenOut()
+
+/*
+  oringsOut, rings with their bridging oxygens, each silicon followed
+  by the oxygen bridging it to the next silicon of the ring, -1 for a
+  direct bond. The lines follow the ring list. 
+  @param sortedCycles, rings sorted in the order that they are connected
+  @param nfile, basename of the output file 
+*/
+void oringsOut(std::vector<std::vector<Vertex*> > &sortedCycles, string nfile)
+{
+  FILE *out; 
+  out = outputOpen(nfile+"_oringlist.dat"); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write" << std::endl; 
+      return; 
+    }
+  for(unsigned int i = 0; i < sortedCycles.size(); i++)
+    {
+      std::vector<Vertex*> &ring = sortedCycles[i]; 
+      for(unsigned int k = 0; k < ring.size(); k++)
+	{
+	  Vertex *next = ring[(k+1) % ring.size()]; 
+	  int e = ring[k]->EdgeIndex(next); 
+	  Vertex *o = e < 0 ? NULL : ring[k]->bridges[e]; 
+	  fprintf(out,"%d %d ",ring[k]->index,o ? o->index : -1); 
+	}
+      fprintf(out,"\n"); 
+    }
+  outputClose(out); 
+}//oringsOut()
@@ -0,0 +1,17 @@
+//bridges.h 
+#ifndef _BRIDGES_H
+#define _BRIDGES_H
+
+#include <vector>
+#include <string>
+
+#include "vertex.h"
+#include "graph.h"
+#include "cell.h"
+
+int contractBridges(Graph &bilayer, float cutoff, const Cell &cell); 
+void connectSi2O(Graph &bilayer, float cutoff, const Cell &cell, std::vector<int> &silicon, std::vector<int> &oxygen); 
+void siOxygenOut(std::vector<int> &silicon, std::vector<int> &oxygen, string nfile="bilayer"); 
+void oringsOut(std::vector<std::vector<Vertex*> > &sortedCycles, string nfile="bilayer"); 
+
+#endif 
@@ -0,0 +1,133 @@
+//cell.cpp 
+#include <cmath>
+
+#include "vertex.h"
+#include "cell.h"
+
+/*
+  Constructors for Cell, a cell that is not periodic, a cell in the
+  plane and a triclinic cell 
+ */
+Cell::Cell() : ax(0), ay(0), az(0), bx(0), by(0), bz(0), cx(0), cy(0), cz(0)
+{
+  init(); 
+}
+
+Cell::Cell(float axIn, float ayIn, float bxIn, float byIn) 
+  : ax(axIn), ay(ayIn), az(0), bx(bxIn), by(byIn), bz(0), cx(0), cy(0), cz(0)
+{
+  init(); 
+}
+
+Cell::Cell(float axIn, float ayIn, float azIn, float bxIn, float byIn, float bzIn, float cxIn, float cyIn, float czIn)
+  : ax(axIn), ay(ayIn), az(azIn), bx(bxIn), by(byIn), bz(bzIn), cx(cxIn), cy(cyIn), cz(czIn)
+{
+  init(); 
+}
+
+/*
+  init, inverse of the cell matrix, to be called when the lattice
+  vectors change 
+*/
+void Cell::init()
+{
+  for(int i = 0; i < 3; i++)
+    for(int j = 0; j < 3; j++)
+      inv[i][j] = 0; 
+  if(periodicz())
+    {
+      //rows of the inverse are the reciprocal vectors, b x c / V and so on 
+      float v = ax*(by*cz - bz*cy) - ay*(bx*cz - bz*cx) + az*(bx*cy - by*cx); 
+      if(v == 0)
+	return; 
+      inv[0][0] = (by*cz - bz*cy)/v; inv[0][1] = (bz*cx - bx*cz)/v; inv[0][2] = (bx*cy - by*cx)/v; 
+      inv[1][0] = (cy*az - cz*ay)/v; inv[1][1] = (cz*ax - cx*az)/v; inv[1][2] = (cx*ay - cy*ax)/v; 
+      inv[2][0] = (ay*bz - az*by)/v; inv[2][1] = (az*bx - ax*bz)/v; inv[2][2] = (ax*by - ay*bx)/v; 
+    }
+  else if(periodic())
+    {
+      float d = det(); 
+      inv[0][0] = by/d; inv[0][1] = -bx/d; 
+      inv[1][0] = -ay/d; inv[1][1] = ax/d; 
+    }
+}//init()
+
+/*
+  cellFractional, a vector in units of the lattice vectors 
+  @param cell, periodic cell 
+  @param dx, dy, dz the vector 
+  @param fa, fb, fc fractional components along a, b and c 
+*/
+void cellFractional(const Cell &cell, float dx, float dy, float dz, float &fa, float &fb, float &fc)
+{
+  fa = cell.inv[0][0]*dx + cell.inv[0][1]*dy + cell.inv[0][2]*dz; 
+  fb = cell.inv[1][0]*dx + cell.inv[1][1]*dy + cell.inv[1][2]*dz; 
+  fc = cell.inv[2][0]*dx + cell.inv[2][1]*dy + cell.inv[2][2]*dz; 
+}//cellFractional()
+
+/*
+  cellShift, translation of a periodic image 
+  @param cell, periodic cell 
+  @param image, lattice vectors of the image 
+  @param sx, sy, sz the translation 
+*/
+void cellShift(const Cell &cell, Image image, float &sx, float &sy, float &sz)
+{
+  sx = image.nx*cell.ax + image.ny*cell.bx + image.nz*cell.cx; 
+  sy = image.nx*cell.ay + image.ny*cell.by + image.nz*cell.cy; 
+  sz = image.nx*cell.az + image.ny*cell.bz + image.nz*cell.cz; 
+}//cellShift()
+
+/*
+  cellMinimumImage, image that brings the end of a vector nearest to its
+  start. Rounding the fractional coordinates is exact for an orthogonal
+  cell, for an oblique cell the images around the rounded one are
+  checked as well. 
+  @param cell, periodic cell 
+  @param dx, dy, dz vector from a vertex to its neighbor 
+  @return lattice vectors to add to the neighbor 
+*/
+Image cellMinimumImage(const Cell &cell, float dx, float dy, float dz)
+{
+  if(!cell.periodic())
+    return Image(); 
+  float fa, fb, fc; 
+  cellFractional(cell,dx,dy,dz,fa,fb,fc); 
+  Image best(-(int)floor(fa + 0.5),-(int)floor(fb + 0.5),-(int)floor(fc + 0.5)); 
+  if(cell.orthogonal())
+    return best; 
+
+  Image center = best; 
+  float sx, sy, sz; 
+  cellShift(cell,best,sx,sy,sz); 
+  float r2 = (dx+sx)*(dx+sx) + (dy+sy)*(dy+sy) + (dz+sz)*(dz+sz); 
+  int kz = cell.periodicz() ? 1 : 0; 
+  for(int i = -1; i <= 1; i++)
+    for(int j = -1; j <= 1; j++)
+      for(int k = -kz; k <= kz; k++)
+	{
+	  Image image(center.nx + i,center.ny + j,center.nz + k); 
+	  cellShift(cell,image,sx,sy,sz); 
+	  float d2 = (dx+sx)*(dx+sx) + (dy+sy)*(dy+sy) + (dz+sz)*(dz+sz); 
+	  if(d2 < r2)
+	    {
+	      r2 = d2; 
+	      best = image; 
+	    }
+	}
+  return best; 
+}//cellMinimumImage()
+
+/*
+  cellMinimumVector, shortest periodic image of a vector 
+  @param cell, periodic cell 
+  @param dx, dy, dz the vector, replaced by its shortest image 
+*/
+void cellMinimumVector(const Cell &cell, float &dx, float &dy, float &dz)
+{
+  float sx, sy, sz; 
+  cellShift(cell,cellMinimumImage(cell,dx,dy,dz),sx,sy,sz); 
+  dx += sx; 
+  dy += sy; 
+  dz += sz; 
+}//cellMinimumVector()
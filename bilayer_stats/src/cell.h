@@ -0,0 +1,35 @@
+//cell.h 
+#ifndef _CELL_H
+#define _CELL_H
+
+#include "vertex.h"
+
+/*
+  Periodic cell of a sample spanned by the lattice vectors a, b and c,
+  not necessarily orthogonal. The image n of a vertex is shifted by
+  nx*a + ny*b + nz*c. A cell is periodic in the plane when a and b span
+  it, and along c only when c is given. Without c the fractional
+  coordinates along a and b are those of the projection on the plane. 
+ */
+struct Cell
+{
+  float ax, ay, az; 
+  float bx, by, bz; 
+  float cx, cy, cz; 
+  float inv[3][3];   //rows map a vector to its fractional coordinates 
+  Cell(); 
+  Cell(float axIn, float ayIn, float bxIn, float byIn); 
+  Cell(float axIn, float ayIn, float azIn, float bxIn, float byIn, float bzIn, float cxIn, float cyIn, float czIn); 
+  void init(); 
+  float det() const { return ax*by - ay*bx; }
+  bool periodic() const { return det() != 0; }
+  bool periodicz() const { return cx != 0 || cy != 0 || cz != 0; }
+  bool orthogonal() const { return ay == 0 && az == 0 && bx == 0 && bz == 0 && cx == 0 && cy == 0; }
+};
+
+void cellFractional(const Cell &cell, float dx, float dy, float dz, float &fa, float &fb, float &fc); 
+void cellShift(const Cell &cell, Image image, float &sx, float &sy, float &sz); 
+Image cellMinimumImage(const Cell &cell, float dx, float dy, float dz); 
+void cellMinimumVector(const Cell &cell, float &dx, float &dy, float &dz); 
+
+#endif 
@@ -0,0 +1,168 @@
+//celllist.cpp 
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#include "vertex.h"
+#include "cell.h"
+#include "celllist.h"
+
+/*
+  binCoordinates, coordinates of a point along the axes of the bins,
+  fractional along the periodic lattice vectors 
+*/
+inline void binCoordinates(const CellList &cells, float x, float y, float z, float r[3])
+{
+  float f[3]; 
+  cellFractional(cells.cell,x,y,z,f[0],f[1],f[2]); 
+  r[0] = cells.wrap[0] ? f[0] : x; 
+  r[1] = cells.wrap[1] ? f[1] : y; 
+  r[2] = cells.wrap[2] ? f[2] : z; 
+}
+
+/*
+  binIndex, bin of a coordinate along one axis, wrapped into the cell
+  along a periodic axis and clamped to the edge bins otherwise 
+*/
+inline int binIndex(const CellList &cells, int k, float r)
+{
+  int c = (int)floor((r - cells.lo[k])/cells.size[k]); 
+  if(cells.wrap[k])
+    {
+      c %= cells.n[k]; 
+      if(c < 0)
+	c += cells.n[k]; 
+    }
+  else if(c < 0)
+    c = 0; 
+  else if(c >= cells.n[k])
+    c = cells.n[k] - 1; 
+  return c; 
+}
+
+/*
+  buildCellList, sorts the vertices by bin with a counting sort 
+  @param vertices, the vertices to bin 
+  @param cutoff, smallest bin width, the range of the neighbor search 
+  @param cell, periodic cell 
+  @param cells, the cell list 
+*/
+void buildCellList(std::vector<Vertex*> &vertices, float cutoff, const Cell &cell, CellList &cells)
+{
+  cells.cutoff = cutoff; 
+  cells.cell = cell; 
+  cells.wrap[0] = cells.wrap[1] = cell.periodic(); 
+  cells.wrap[2] = cell.periodicz(); 
+
+  //width of the cell between the faces not containing each lattice vector 
+  float width[3] = {0,0,0}; 
+  if(cell.periodic())
+    {
+      float la = sqrt(cell.inv[0][0]*cell.inv[0][0] + cell.inv[0][1]*cell.inv[0][1] + cell.inv[0][2]*cell.inv[0][2]); 
+      float lb = sqrt(cell.inv[1][0]*cell.inv[1][0] + cell.inv[1][1]*cell.inv[1][1] + cell.inv[1][2]*cell.inv[1][2]); 
+      float lc = sqrt(cell.inv[2][0]*cell.inv[2][0] + cell.inv[2][1]*cell.inv[2][1] + cell.inv[2][2]*cell.inv[2][2]); 
+      width[0] = 1/la; 
+      width[1] = 1/lb; 
+      if(cells.wrap[2])
+	width[2] = 1/lc; 
+    }
+
+  float rmin[3] = {0,0,0}, rmax[3] = {0,0,0}; 
+  for(unsigned int i = 0; i < vertices.size(); i++)
+    {
+      float r[3]; 
+      binCoordinates(cells,vertices[i]->x,vertices[i]->y,vertices[i]->z,r); 
+      for(int k = 0; k < 3; k++)
+	{
+	  if(i == 0 || r[k] < rmin[k]) rmin[k] = r[k]; 
+	  if(i == 0 || r[k] > rmax[k]) rmax[k] = r[k]; 
+	}
+    }
+  for(int k = 0; k < 3; k++)
+    {
+      float length = cells.wrap[k] ? width[k] : rmax[k] - rmin[k]; 
+      cells.n[k] = cutoff > 0 ? (int)floor(length/cutoff) : 1; 
+      if(cells.n[k] < 1)
+	cells.n[k] = 1; 
+      cells.lo[k] = cells.wrap[k] ? 0 : rmin[k]; 
+      if(cells.wrap[k])
+	cells.size[k] = 1.0/cells.n[k]; 
+      else
+	cells.size[k] = length > 0 ? length/cells.n[k] : 1; 
+    }
+
+  int ncell = cells.n[0]*cells.n[1]*cells.n[2]; 
+  std::vector<int> bin(vertices.size()); 
+  cells.offset.assign(ncell+1,0); 
+  for(unsigned int i = 0; i < vertices.size(); i++)
+    {
+      float r[3]; 
+      binCoordinates(cells,vertices[i]->x,vertices[i]->y,vertices[i]->z,r); 
+      bin[i] = (binIndex(cells,2,r[2])*cells.n[1] + binIndex(cells,1,r[1]))*cells.n[0] + binIndex(cells,0,r[0]); 
+      cells.offset[bin[i]+1]++; 
+    }
+  for(int c = 0; c < ncell; c++)
+    cells.offset[c+1] += cells.offset[c]; 
+  std::vector<int> fill(cells.offset.begin(),cells.offset.end()-1); 
+  cells.members.resize(vertices.size()); 
+  for(unsigned int i = 0; i < vertices.size(); i++)
+    cells.members[fill[bin[i]]++] = vertices[i]; 
+}//buildCellList()
+
+/*
+  cellNeighbors, the vertices within the cutoff of a point, with the
+  minimum image in a periodic cell 
+  @param cells, the cell list 
+  @param x, y, z the point 
+  @param neighbors, filled with the vertices in range 
+*/
+void cellNeighbors(CellList &cells, float x, float y, float z, std::vector<Vertex*> &neighbors)
+{
+  neighbors.clear(); 
+  float r[3]; 
+  binCoordinates(cells,x,y,z,r); 
+  int lo[3], hi[3]; 
+  for(int k = 0; k < 3; k++)
+    {
+      int c = binIndex(cells,k,r[k]); 
+      lo[k] = c - 1; 
+      hi[k] = c + 1; 
+      //with fewer than 3 bins along a periodic axis every bin is a neighbor once 
+      if(cells.wrap[k] && cells.n[k] < 3)
+	{
+	  lo[k] = 0; 
+	  hi[k] = cells.n[k] - 1; 
+	}
+    }
+  float cut2 = cells.cutoff*cells.cutoff; 
+  bool periodic = cells.cell.periodic(); 
+
+  for(int k = lo[2]; k <= hi[2]; k++)
+    {
+      int kk = cells.wrap[2] ? (k + cells.n[2]) % cells.n[2] : k; 
+      if(kk < 0 || kk >= cells.n[2])
+	continue; 
+      for(int j = lo[1]; j <= hi[1]; j++)
+	{
+	  int jj = cells.wrap[1] ? (j + cells.n[1]) % cells.n[1] : j; 
+	  if(jj < 0 || jj >= cells.n[1])
+	    continue; 
+	  for(int i = lo[0]; i <= hi[0]; i++)
+	    {
+	      int ii = cells.wrap[0] ? (i + cells.n[0]) % cells.n[0] : i; 
+	      if(ii < 0 || ii >= cells.n[0])
+		continue; 
+	      int c = (kk*cells.n[1] + jj)*cells.n[0] + ii; 
+	      for(int m = cells.offset[c]; m < cells.offset[c+1]; m++)
+		{
+		  Vertex *v = cells.members[m]; 
+		  float dx = v->x - x, dy = v->y - y, dz = v->z - z; 
+		  if(periodic)
+		    cellMinimumVector(cells.cell,dx,dy,dz); 
+		  if(dx*dx + dy*dy + dz*dz < cut2)
+		    neighbors.push_back(v); 
+		}
+	    }
+	}
+    }
+}//cellNeighbors()
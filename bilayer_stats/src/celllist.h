@@ -0,0 +1,33 @@
+//celllist.h 
+#ifndef _CELLLIST_H
+#define _CELLLIST_H
+
+#include <vector>
+
+#include "vertex.h"
+#include "cell.h"
+
+/*
+  Cell list of a set of vertices. The bins are at least as wide as the
+  cutoff, so the neighbors of a point within the cutoff are in the bins
+  around the bin of the point. Along the periodic lattice vectors the
+  bins are slices of the fractional coordinates, along the other axes
+  slices of x, y or z. The vertices are sorted by bin, the vertices of
+  bin c are members[offset[c]] to members[offset[c+1]-1]. 
+ */
+struct CellList
+{
+  float cutoff; 
+  Cell cell; 
+  bool wrap[3];     //periodic axis 
+  float lo[3];      //lower edge of the bins 
+  float size[3];    //size of a bin 
+  int n[3];         //number of bins 
+  std::vector<int> offset; 
+  std::vector<Vertex*> members; 
+};
+
+void buildCellList(std::vector<Vertex*> &vertices, float cutoff, const Cell &cell, CellList &cells); 
+void cellNeighbors(CellList &cells, float x, float y, float z, std::vector<Vertex*> &neighbors); 
+
+#endif 
@@ -0,0 +1,282 @@
+//edits.cpp 
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <set>
+#include <cmath>
+#include <cstdio>
+
+#include "vertex.h"
+#include "graph.h"
+#include "celllist.h"
+#include "edits.h"
+#include "asyncwriter.h"
+#include "log.h"
+
+/*
+  parseEdits, reads edge edits, each "add i j" or "remove i j", separated
+  by spaces or newlines. A # starts a comment to the end of the line. 
+  @param text, the edits 
+  @param edits, the edits read are added here 
+  @return 0, -1 if an edit is malformed 
+*/
+int parseEdits(const char *text, std::vector<EdgeEdit> &edits)
+{
+  std::istringstream lines(text); 
+  string line; 
+  while(std::getline(lines,line))
+    {
+      std::istringstream in(line.substr(0,line.find('#'))); 
+      string op; 
+      while(in >> op)
+	{
+	  EdgeEdit edit; 
+	  if(op != "add" && op != "remove")
+	    {
+	      std::cerr << "Edge edits are add or remove, not: " << op << std::endl; 
+	      return -1; 
+	    }
+	  edit.add = (op == "add"); 
+	  if(!(in >> edit.i >> edit.j) || edit.i < 0 || edit.j < 0 || edit.i == edit.j)
+	    {
+	      std::cerr << "Edge edit " << op << " needs two different vertex indices" << std::endl; 
+	      return -1; 
+	    }
+	  edits.push_back(edit); 
+	}
+    }
+  return 0; 
+}//parseEdits()
+
+/*
+  readEdits, reads the edge edits of a file, in the format of parseEdits 
+  @param file, edits file 
+  @param edits, the edits read are added here 
+  @return 0, -1 if the file cannot be read or an edit is malformed 
+*/
+int readEdits(const char *file, std::vector<EdgeEdit> &edits)
+{
+  std::ifstream in(file); 
+  if(!in)
+    {
+      std::cerr << "Cannot open file: " << file << std::endl; 
+      return -1; 
+    }
+  std::stringstream text; 
+  text << in.rdbuf(); 
+  return parseEdits(text.str().c_str(),edits); 
+}//readEdits()
+
+/*
+  applyEdits, adds and removes edges of a bonded graph, all at once
+  before the bridges are contracted and the rings searched. Added edges
+  bond the nearest periodic images. The edits are checked before any is
+  applied. 
+  @param bilayer, graph of the sample 
+  @param edits, the edits 
+  @param cell, periodic cell 
+  @return 0, -1 if an edit names a vertex out of range 
+*/
+int applyEdits(Graph &bilayer, const std::vector<EdgeEdit> &edits, const Cell &cell)
+{
+  int n = bilayer.vertices.size(); 
+  for(unsigned int k = 0; k < edits.size(); k++)
+    {
+      if(edits[k].i >= n || edits[k].j >= n)
+	{
+	  std::cerr << "Edge edit " << edits[k].i << " " << edits[k].j << " is out of range of the " << n << " vertices" << std::endl; 
+	  return -1; 
+	}
+    }
+  int nadd = 0, nremove = 0; 
+  for(unsigned int k = 0; k < edits.size(); k++)
+    {
+      Vertex *vi = bilayer.vertices[edits[k].i]; 
+      Vertex *vj = bilayer.vertices[edits[k].j]; 
+      if(edits[k].add)
+	{
+	  if(vi->EdgeIndex(vj) >= 0)
+	    LOG(LOG_WARN) << "Edge " << edits[k].i << " " << edits[k].j << " to add is already bonded" << std::endl; 
+	  else
+	    {
+	      vi->AddPeriodicEdge(vj,cell); 
+	      nadd++; 
+	    }
+	}
+      else if(vi->RemoveEdge(vj) != 0)
+	LOG(LOG_WARN) << "Edge " << edits[k].i << " " << edits[k].j << " to remove is not bonded" << std::endl; 
+      else
+	nremove++; 
+    }
+  LOG(LOG_INFO) << "Edge edits: " << nadd << " added, " << nremove << " removed" << std::endl; 
+  return 0; 
+}//applyEdits()
+
+/*
+  edgeLength, distance between a vertex and the nearest periodic image
+  of another 
+ */
+static float edgeLength(Vertex *a, Vertex *b, const Cell &cell)
+{
+  Image image = a->MinimumImage(b,cell); 
+  float sx, sy, sz; 
+  cellShift(cell,image,sx,sy,sz); 
+  float dx = b->x + sx - a->x; 
+  float dy = b->y + sy - a->y; 
+  float dz = b->z + sz - a->z; 
+  return sqrt(dx*dx + dy*dy + dz*dz); 
+}//edgeLength()
+
+/*
+  proposeEdits, finds coordination defects and proposes edits that fix
+  them. The expected coordination of each element is the most common
+  one in the sample. An over-coordinated vertex loses its longest edges,
+  an under-coordinated vertex is bonded to the nearest under-coordinated
+  vertex of an element it bonds to, within 1.5 times the mean bond
+  length. The graph is not changed. 
+  @param bilayer, graph of the sample 
+  @param cell, periodic cell 
+  @param edits, the proposed edits 
+  @return the number of vertices with a defect 
+*/
+int proposeEdits(Graph &bilayer, const Cell &cell, std::vector<EdgeEdit> &edits)
+{
+  std::vector<Vertex*> &vertices = bilayer.vertices; 
+
+  //most common coordination of each element, elements bonded together
+  //and the mean bond length 
+  std::map<int, std::map<int,int> > histogram; 
+  std::set<std::pair<int,int> > bonded; 
+  double length = 0; 
+  long nbonds = 0; 
+  for(unsigned int i = 0; i < vertices.size(); i++)
+    {
+      Vertex *v = vertices[i]; 
+      histogram[v->atomno][v->edges.size()]++; 
+      for(unsigned int k = 0; k < v->edges.size(); k++)
+	{
+	  bonded.insert(std::make_pair(v->atomno,v->edges[k]->atomno)); 
+	  float dx, dy, dz; 
+	  v->BondVector(k,cell,dx,dy,dz); 
+	  length += sqrt(dx*dx + dy*dy + dz*dz); 
+	  nbonds++; 
+	}
+    }
+  if(nbonds == 0)
+    return 0; 
+  float cutoff = 1.5*length/nbonds; 
+  std::map<int,int> expected; 
+  for(std::map<int, std::map<int,int> >::iterator t = histogram.begin(); t != histogram.end(); ++t)
+    {
+      int mode = 0, count = -1; 
+      for(std::map<int,int>::iterator c = t->second.begin(); c != t->second.end(); ++c)
+	if(c->second > count)
+	  {
+	    mode = c->first; 
+	    count = c->second; 
+	  }
+      expected[t->first] = mode; 
+    }
+
+  //excess edges of each vertex, negative for missing edges 
+  std::vector<int> excess(vertices.size()); 
+  int ndefects = 0; 
+  for(unsigned int i = 0; i < vertices.size(); i++)
+    {
+      excess[i] = (int)vertices[i]->edges.size() - expected[vertices[i]->atomno]; 
+      if(excess[i] != 0)
+	ndefects++; 
+    }
+
+  //remove the longest edges of over-coordinated vertices 
+  for(unsigned int i = 0; i < vertices.size(); i++)
+    {
+      Vertex *v = vertices[i]; 
+      std::vector<std::pair<float,int> > longest; 
+      for(unsigned int k = 0; k < v->edges.size() && excess[i] > 0; k++)
+	longest.push_back(std::make_pair(-edgeLength(v,v->edges[k],cell),v->edges[k]->index)); 
+      std::sort(longest.begin(),longest.end()); 
+      for(unsigned int k = 0; k < longest.size() && excess[i] > 0; k++)
+	{
+	  int j = longest[k].second; 
+	  bool proposed = false; 
+	  for(unsigned int e = 0; e < edits.size() && !proposed; e++)
+	    proposed = !edits[e].add && edits[e].i == j && edits[e].j == (int)i; 
+	  if(proposed)
+	    continue; 
+	  edits.push_back(EdgeEdit(false,i,j)); 
+	  excess[i]--; 
+	  excess[j]--; 
+	}
+    }
+
+  //bond under-coordinated vertices to their nearest under-coordinated
+  //partner, searched in a cell list of the under-coordinated vertices,
+  //the nearer index first on a tie 
+  std::vector<int> missing; 
+  std::vector<Vertex*> partners; 
+  for(unsigned int i = 0; i < vertices.size(); i++)
+    if(excess[i] < 0)
+      {
+	missing.push_back(i); 
+	partners.push_back(vertices[i]); 
+      }
+  CellList cells; 
+  if(!partners.empty())
+    buildCellList(partners,cutoff,cell,cells); 
+  std::vector<Vertex*> neighbors; 
+  for(unsigned int a = 0; a < missing.size(); a++)
+    {
+      int i = missing[a]; 
+      if(excess[i] < 0)
+	cellNeighbors(cells,vertices[i]->x,vertices[i]->y,vertices[i]->z,neighbors); 
+      while(excess[i] < 0)
+	{
+	  int best = -1; 
+	  float bestLength = cutoff; 
+	  for(unsigned int b = 0; b < neighbors.size(); b++)
+	    {
+	      int j = neighbors[b]->index; 
+	      if(j == i || excess[j] >= 0 || vertices[i]->EdgeIndex(vertices[j]) >= 0)
+		continue; 
+	      if(!bonded.count(std::make_pair(vertices[i]->atomno,vertices[j]->atomno)))
+		continue; 
+	      float r = edgeLength(vertices[i],vertices[j],cell); 
+	      if(r < bestLength || (r == bestLength && j < best))
+		{
+		  best = j; 
+		  bestLength = r; 
+		}
+	    }
+	  if(best < 0)
+	    break; 
+	  edits.push_back(EdgeEdit(true,i,best)); 
+	  excess[i]++; 
+	  excess[best]++; 
+	}
+    }
+  return ndefects; 
+}//proposeEdits()
+
+/*
+  editsOut, proposed edits in the format of an edits file 
+  @param edits, the edits 
+  @param nfile, basename of the output file 
+*/
+void editsOut(std::vector<EdgeEdit> &edits, string nfile)
+{
+  FILE *out; 
+  out = outputOpen(nfile+"_edits.dat"); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write" << std::endl; 
+      return; 
+    }
+  fprintf(out,"# edge edits proposed for the coordination defects\n"); 
+  for(unsigned int i = 0; i < edits.size(); i++)
+    fprintf(out,"%s %d %d\n",edits[i].add ? "add" : "remove",edits[i].i,edits[i].j); 
+  outputClose(out); 
+}//editsOut()
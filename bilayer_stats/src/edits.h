@@ -0,0 +1,31 @@
+//edits.h 
+#ifndef _EDITS_H
+#define _EDITS_H
+
+#include <vector>
+#include <string>
+
+#include "vertex.h"
+#include "graph.h"
+#include "cell.h"
+
+/*
+  An edge to add or remove between two vertices, by their index in the
+  coordinates file 
+ */
+struct EdgeEdit
+{
+  bool add; 
+  int i; 
+  int j; 
+  EdgeEdit() : add(false), i(0), j(0) {}
+  EdgeEdit(bool addIn, int iIn, int jIn) : add(addIn), i(iIn), j(jIn) {}
+};
+
+int parseEdits(const char *text, std::vector<EdgeEdit> &edits); 
+int readEdits(const char *file, std::vector<EdgeEdit> &edits); 
+int applyEdits(Graph &bilayer, const std::vector<EdgeEdit> &edits, const Cell &cell); 
+int proposeEdits(Graph &bilayer, const Cell &cell, std::vector<EdgeEdit> &edits); 
+void editsOut(std::vector<EdgeEdit> &edits, string nfile="bilayer"); 
+
+#endif
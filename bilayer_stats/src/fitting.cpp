@@ -0,0 +1,358 @@
+//fitting.cpp 
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <pthread.h>
+
+#include "fitting.h"
+#include "asyncwriter.h"
+#include "threadbudget.h"
+#include "log.h"
+
+const double PI = 3.14159265358979323846; 
+
+/*
+  linearFit, least squares line through the points 
+  @param points, the points 
+  @param npoints, number of points
+  @param origin, fit y = slope*x through the origin 
+  @param slope, intercept, the fitted line 
+  @return false if the line is undetermined 
+*/
+bool linearFit(const FitPoint *points, int npoints, bool origin, double &slope, double &intercept)
+{
+  double sx = 0., sy = 0., sxx = 0., sxy = 0.; 
+  for(int i = 0; i < npoints; i++)
+    {
+      double x = points[i].x, y = points[i].y; 
+      sx += x; 
+      sy += y; 
+      sxx += x*x; 
+      sxy += x*y; 
+    }
+  slope = 0.; 
+  intercept = 0.; 
+  if(origin)
+    {
+      if(sxx == 0)
+	return false; 
+      slope = sxy/sxx; 
+      return true; 
+    }
+  double det = npoints*sxx - sx*sx; 
+  if(npoints < 2 || det == 0)
+    return false; 
+  slope = (npoints*sxy - sx*sy)/det; 
+  intercept = (sy - slope*sx)/npoints; 
+  return true; 
+}//linearFit()
+
+/*
+  Resamples handed to one bootstrap thread, each with its own random
+  stream so the result does not depend on the scheduling 
+ */
+struct BootstrapTask
+{
+  const std::vector<FitPoint> *points; 
+  bool origin; 
+  int first; 
+  int last; 
+  unsigned int seed; 
+  double *slope; 
+  double *intercept; 
+  char *valid; 
+};
+
+/*
+  xorshift128, small random number generator of each thread 
+ */
+struct RandomStream
+{
+  unsigned int s[4]; 
+  RandomStream(unsigned int seed)
+  {
+    //spread the seed over the state, which must not be all zero 
+    for(int i = 0; i < 4; i++)
+      {
+	seed = seed*1664525u + 1013904223u; 
+	s[i] = seed ^ (seed >> 16) ^ 0x9e3779b9u; 
+      }
+  }
+  unsigned int next()
+  {
+    unsigned int t = s[3]; 
+    t ^= t << 11; 
+    t ^= t >> 8; 
+    s[3] = s[2]; s[2] = s[1]; s[1] = s[0]; 
+    t ^= s[0] ^ (s[0] >> 19); 
+    s[0] = t; 
+    return t; 
+  }
+};
+
+/*
+  bootstrapWorker, refits the resamples first to last-1, drawing as
+  many points as the sample with replacement. A resample whose points
+  do not determine the line, as when all of them have the same x, is
+  marked not valid. 
+ */
+void* bootstrapWorker(void *arg)
+{
+  BootstrapTask *task = (BootstrapTask*)arg; 
+  const std::vector<FitPoint> &points = *task->points; 
+  int npoints = points.size(); 
+  double scale = npoints/4294967296.0; 
+  for(int b = task->first; b < task->last; b++)
+    {
+      RandomStream random(task->seed + 2654435761u*b); 
+      double sx = 0., sy = 0., sxx = 0., sxy = 0.; 
+      for(int i = 0; i < npoints; i++)
+	{
+	  const FitPoint &p = points[(int)(random.next()*scale)]; 
+	  sx += p.x; 
+	  sy += p.y; 
+	  sxx += (double)p.x*p.x; 
+	  sxy += (double)p.x*p.y; 
+	}
+      double slope = 0., intercept = 0.; 
+      bool valid; 
+      if(task->origin)
+	{
+	  valid = sxx != 0; 
+	  if(valid)
+	    slope = sxy/sxx; 
+	}
+      else
+	{
+	  double det = npoints*sxx - sx*sx; 
+	  valid = det != 0; 
+	  if(valid)
+	    {
+	      slope = (npoints*sxy - sx*sy)/det; 
+	      intercept = (sy - slope*sx)/npoints; 
+	    }
+	}
+      task->slope[b] = slope; 
+      task->intercept[b] = intercept; 
+      task->valid[b] = valid; 
+    }
+  return NULL; 
+}//bootstrapWorker()
+
+/*
+  percentile, value below which a fraction of the values fall.
+  Reorders the values. 
+*/
+double percentile(std::vector<double> &values, double fraction)
+{
+  unsigned int k = (unsigned int)(fraction*(values.size() - 1) + 0.5); 
+  std::nth_element(values.begin(),values.begin() + k,values.end()); 
+  return values[k]; 
+}//percentile()
+
+/*
+  bootstrapFit, fits the points and estimates the 95% interval of the
+  parameters from resamples of the points, split over threads. The
+  resamples that do not determine the line are left out of the interval. 
+  @param points, one point per ring 
+  @param origin, fit through the origin 
+  @param nresample, number of resamples, no interval if 0 
+  @param nthreads, largest number of threads, with the calling thread,
+  as many as the thread budget gives if not positive 
+  @param seed, seed of the resamples 
+  @param fit, the fit and its interval 
+*/
+void bootstrapFit(std::vector<FitPoint> &points, bool origin, int nresample, int nthreads, unsigned int seed, LinearFit &fit)
+{
+  fit = LinearFit(); 
+  fit.npoints = points.size(); 
+  if(points.empty())
+    return; 
+  fit.fitted = linearFit(&points[0],points.size(),origin,fit.slope,fit.intercept); 
+  if(!fit.fitted)
+    return; 
+  if(nresample <= 0)
+    return; 
+
+  //the calling thread takes the first share, helpers the others 
+  if(nthreads <= 0 || nthreads > nresample)
+    nthreads = nresample; 
+  int helpers = threadsAcquire(nthreads - 1); 
+  nthreads = helpers + 1; 
+  std::vector<double> slope(nresample), intercept(nresample); 
+  std::vector<char> valid(nresample); 
+  std::vector<BootstrapTask> tasks(nthreads); 
+  std::vector<pthread_t> threads(nthreads); 
+  for(int t = nthreads - 1; t >= 0; t--)
+    {
+      tasks[t].points = &points; 
+      tasks[t].origin = origin; 
+      tasks[t].first = (long)nresample*t/nthreads; 
+      tasks[t].last = (long)nresample*(t+1)/nthreads; 
+      tasks[t].seed = seed; 
+      tasks[t].slope = &slope[0]; 
+      tasks[t].intercept = &intercept[0]; 
+      tasks[t].valid = &valid[0]; 
+      if(t > 0)
+	pthread_create(&threads[t],NULL,bootstrapWorker,&tasks[t]); 
+      else
+	bootstrapWorker(&tasks[t]); 
+    }
+  for(int t = 1; t < nthreads; t++)
+    pthread_join(threads[t],NULL); 
+  threadsRelease(helpers); 
+
+  //keep the resamples that determine the line 
+  int nvalid = 0; 
+  for(int b = 0; b < nresample; b++)
+    if(valid[b])
+      {
+	slope[nvalid] = slope[b]; 
+	intercept[nvalid] = intercept[b]; 
+	nvalid++; 
+      }
+  slope.resize(nvalid); 
+  intercept.resize(nvalid); 
+  fit.nvalid = nvalid; 
+  if(nvalid < BOOTSTRAP_MIN_VALID)
+    return; 
+  fit.interval = true; 
+  fit.slopelow = percentile(slope,0.025); 
+  fit.slopehigh = percentile(slope,0.975); 
+  fit.interceptlow = percentile(intercept,0.025); 
+  fit.intercepthigh = percentile(intercept,0.975); 
+}//bootstrapFit()
+
+/*
+  finitePoint, false for a point with a NaN or infinite coordinate,
+  which would spoil the whole fit 
+*/
+static bool finitePoint(const FitPoint &p)
+{
+  return p.x - p.x == 0 && p.y - p.y == 0; 
+}//finitePoint()
+
+/*
+  ringFits, fits the Lewis, Aboav-Weaire and area laws over the rings
+  of a sample. Rings across the periodic box are left out of the area
+  fits as they are of the area statistics. 
+  @param coords, ring coordinates, for the size of each ring and the
+  rings that wrap 
+  @param geometry, ring areas 
+  @param aboavStack, average neighbor ring size of each ring, at the
+  index of its size, rings without neighbor rings are skipped 
+  @param bndlength, average bond length b 
+  @param nresample, number of bootstrap resamples 
+  @param fits, the fitted laws 
+*/
+void ringFits(RingCoords &coords, RingGeometry &geometry, 
+	      std::vector<std::vector<double> > &aboavStack, double bndlength, int nresample, RingFits &fits)
+{
+  std::vector<FitPoint> lewis, arealaw, aboav; 
+  double b2 = bndlength*bndlength; 
+  for(unsigned int n = 3; n < coords.count.size() && b2 > 0; n++)
+    for(int r = 0; r < coords.count[n]; r++)
+      {
+	int i = coords.ring[coords.start[n] + r]; 
+	if(coords.wraps[i])
+	  continue; 
+	FitPoint p; 
+	p.x = n; 
+	p.y = geometry.area[i]/b2; 
+	if(!finitePoint(p))
+	  continue; 
+	lewis.push_back(p); 
+	p.x = 0.25*n/std::tan(PI/n); 
+	arealaw.push_back(p); 
+      }
+  for(unsigned int i = 0; i < aboavStack.size(); i++)
+    for(unsigned int n = 0; n < aboavStack[i].size(); n++)
+      if(aboavStack[i][n] > 0)   //rings without neighbors have no average 
+	{
+	  FitPoint p; 
+	  p.x = n; 
+	  p.y = n*aboavStack[i][n]; 
+	  if(finitePoint(p))
+	    aboav.push_back(p); 
+	}
+
+  fits.nresample = nresample; 
+  bootstrapFit(lewis,false,nresample,0,1,fits.lewis); 
+  bootstrapFit(aboav,false,nresample,0,2,fits.aboav); 
+  bootstrapFit(arealaw,true,nresample,0,3,fits.arealaw); 
+}//ringFits()
+
+/*
+  fitsOut, the fitted laws with their 95% intervals, a law that could
+  not be fitted is reported as no fit with its number of points, a law
+  with too few resamples that determine the line as no interval with
+  its number of points and of those resamples 
+  @param fits, the fitted laws 
+  @param nfile, basename of the output file 
+*/
+void fitsOut(RingFits &fits, string nfile)
+{
+  FILE *out; 
+  out = outputOpen(nfile+"_fits.dat"); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write" << std::endl; 
+      return; 
+    }
+  LinearFit &l = fits.lewis, &a = fits.aboav, &k = fits.arealaw; 
+  fprintf(out,"#law parameter value low high points, 95%% interval from %d bootstrap resamples\n",fits.nresample); 
+  if(!l.fitted)
+    fprintf(out,"lewis no fit %d\n",l.npoints); 
+  else if(l.interval)
+    {
+      fprintf(out,"lewis slope %f %f %f %d\n",l.slope,l.slopelow,l.slopehigh,l.npoints); 
+      fprintf(out,"lewis intercept %f %f %f %d\n",l.intercept,l.interceptlow,l.intercepthigh,l.npoints); 
+    }
+  else
+    {
+      fprintf(out,"lewis slope %f no interval %d %d\n",l.slope,l.npoints,l.nvalid); 
+      fprintf(out,"lewis intercept %f no interval %d %d\n",l.intercept,l.npoints,l.nvalid); 
+    }
+  if(!a.fitted)
+    fprintf(out,"aboav no fit %d\n",a.npoints); 
+  else if(a.interval)
+    {
+      fprintf(out,"aboav slope %f %f %f %d\n",a.slope,a.slopelow,a.slopehigh,a.npoints); 
+      fprintf(out,"aboav intercept %f %f %f %d\n",a.intercept,a.interceptlow,a.intercepthigh,a.npoints); 
+      fprintf(out,"aboav alpha %f %f %f %d\n",6 - a.slope,6 - a.slopehigh,6 - a.slopelow,a.npoints); 
+    }
+  else
+    {
+      fprintf(out,"aboav slope %f no interval %d %d\n",a.slope,a.npoints,a.nvalid); 
+      fprintf(out,"aboav intercept %f no interval %d %d\n",a.intercept,a.npoints,a.nvalid); 
+      fprintf(out,"aboav alpha %f no interval %d %d\n",6 - a.slope,a.npoints,a.nvalid); 
+    }
+  if(!k.fitted)
+    fprintf(out,"arealaw no fit %d\n",k.npoints); 
+  else if(k.interval)
+    fprintf(out,"arealaw k %f %f %f %d\n",k.slope,k.slopelow,k.slopehigh,k.npoints); 
+  else
+    fprintf(out,"arealaw k %f no interval %d %d\n",k.slope,k.npoints,k.nvalid); 
+  outputClose(out); 
+
+  if(!l.fitted)
+    LOG(LOG_INFO) << "Lewis law: no fit, " << l.npoints << " points" << std::endl; 
+  else if(l.interval)
+    LOG(LOG_INFO) << "Lewis slope " << l.slope << " [" << l.slopelow << ", " << l.slopehigh << "]" << std::endl; 
+  else
+    LOG(LOG_INFO) << "Lewis slope " << l.slope << ", no interval" << std::endl; 
+  if(!a.fitted)
+    LOG(LOG_INFO) << "Aboav-Weaire law: no fit, " << a.npoints << " points" << std::endl; 
+  else if(a.interval)
+    LOG(LOG_INFO) << "Aboav-Weaire alpha " << 6 - a.slope << " [" << 6 - a.slopehigh << ", " << 6 - a.slopelow << "]" << std::endl; 
+  else
+    LOG(LOG_INFO) << "Aboav-Weaire alpha " << 6 - a.slope << ", no interval" << std::endl; 
+  if(!k.fitted)
+    LOG(LOG_INFO) << "Area law: no fit, " << k.npoints << " points" << std::endl; 
+  else if(k.interval)
+    LOG(LOG_INFO) << "Area law k " << k.slope << " [" << k.slopelow << ", " << k.slopehigh << "]" << std::endl; 
+  else
+    LOG(LOG_INFO) << "Area law k " << k.slope << ", no interval" << std::endl; 
+}//fitsOut()
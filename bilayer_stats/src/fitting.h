@@ -0,0 +1,65 @@
+//fitting.h 
+#ifndef _FITTING_H
+#define _FITTING_H
+
+#include <vector>
+#include <string>
+
+#include "vertex.h"
+#include "ringgeom.h"
+
+/*
+  One point of a fit, one ring 
+ */
+struct FitPoint
+{
+  float x; 
+  float y; 
+};
+
+#define BOOTSTRAP_MIN_VALID 40
+
+/*
+  Least squares line y = slope*x + intercept, with the 95% bootstrap
+  interval of each parameter. A fit through the origin has intercept 0.
+  A fit without points, or whose points do not determine the line, is
+  not fitted. The interval is taken over the resamples that determine
+  the line, and left out if fewer than BOOTSTRAP_MIN_VALID do. 
+ */
+struct LinearFit
+{
+  bool fitted; 
+  bool interval; 
+  int npoints; 
+  int nvalid;          //resamples that determine the line 
+  double slope; 
+  double intercept; 
+  double slopelow; 
+  double slopehigh; 
+  double interceptlow; 
+  double intercepthigh; 
+  LinearFit() : fitted(false), interval(false), npoints(0), nvalid(0), slope(0), intercept(0), slopelow(0), slopehigh(0), 
+    interceptlow(0), intercepthigh(0) {}
+};
+
+/*
+  Ring laws of a sample. Lewis law A_n/b^2 = slope*n + intercept,
+  Aboav-Weaire law n*m_n = (6-alpha)*n + 6*alpha + mu2 and the area law
+  A_n/b^2 = k*(n/4)*cot(pi/n), the area of a regular n-ring of bond b
+  scaled by k. 
+ */
+struct RingFits
+{
+  LinearFit lewis; 
+  LinearFit aboav; 
+  LinearFit arealaw; 
+  int nresample; 
+};
+
+bool linearFit(const FitPoint *points, int npoints, bool origin, double &slope, double &intercept); 
+void bootstrapFit(std::vector<FitPoint> &points, bool origin, int nresample, int nthreads, unsigned int seed, LinearFit &fit); 
+void ringFits(RingCoords &coords, RingGeometry &geometry, 
+	      std::vector<std::vector<double> > &aboavStack, double bndlength, int nresample, RingFits &fits); 
+void fitsOut(RingFits &fits, string nfile="bilayer"); 
+
+#endif 
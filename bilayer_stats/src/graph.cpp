@@ -6,6 +6,8 @@
 
 #include "graph.h"
 #include "vertex.h"
+#include "ringkernel.h"
+#include "profile.h"
 
 /*
   Constructor for Graph 
@@ -15,6 +17,27 @@ Graph::Graph()
   
 }//Graph()
 
+/*
+  Destructor for Graph, the graph owns its vertices 
+ */
+Graph::~Graph()
+{
+  clear(); 
+}//~Graph()
+
+/*
+  clear, deletes the vertices and bridges, leaving an empty graph 
+ */
+void Graph::clear()
+{
+  for(unsigned int i = 0; i < vertices.size(); i++)
+    delete vertices[i]; 
+  for(unsigned int i = 0; i < bridges.size(); i++)
+    delete bridges[i]; 
+  vertices.clear(); 
+  bridges.clear(); 
+}//clear()
+
 /*
   performs the breadth first search algorthium
   @param xFind: x coordinate to find
@@ -112,29 +135,18 @@ void avoidSuperRing(vector <vector<Vertex*> > &cycleList)
   to the cyclelist
   @param cycleList: List of all Cycles
   @param cycle found by findCyclesToSelf
+  @return true if the cycle was added, false if it was a repeat
 */
-void AddNoRepeats(std::vector<std::vector<Vertex*> > &cycleList, std::vector<Vertex*>& cycle)
+bool AddNoRepeats(std::vector<std::vector<Vertex*> > &cycleList, std::vector<Vertex*>& cycle)
 {
-  std::sort(cycle.begin(), cycle.end());
+  ringCanonical(cycle);
   for(unsigned int i = 0; i < cycleList.size(); i++)
     {
-      if(cycleList[i].size() == cycle.size())
-	{
-	  bool theSame = true;
-	  for(unsigned int j = 0; j < cycle.size(); j++)
-	    {
-	      if((cycleList[i])[j] != cycle[j])
-		{
-		  theSame = false;
-		  break;
-		}
-	    }
-	  
-	  if(theSame)
-	    return;
-	}
+      if(ringSame(cycleList[i], cycle))
+	return false;
     }
   cycleList.push_back(cycle);
+  return true;
 }
 
 void Vertex::findCyclesToSelf(int maxCycleSize, std::vector<std::vector<Vertex*> > &cycleList)
@@ -143,6 +155,8 @@ void Vertex::findCyclesToSelf(int maxCycleSize, std::vector<std::vector<Vertex*>
   double yFind = y; //Coordinates to find 
   
   int levelSize = 1;
+  long expanded = 0, repeats = 0; //work for the profile
+  size_t pathBytes = 0;            //largest level of paths, for the memory report
   std::vector<Vertex*> fifo;
   std::vector<Vertex*> parentFo;
   std::vector<std::vector<Vertex*> > cycleTron;
@@ -163,17 +177,21 @@ void Vertex::findCyclesToSelf(int maxCycleSize, std::vector<std::vector<Vertex*>
 	    {
 	      if(fifo[0]->x == xFind && fifo[0]->y == yFind) 
 		{
-		  AddNoRepeats(cycleList, cycleTron[i]);
+		  if(!AddNoRepeats(cycleList, cycleTron[i]))
+		    repeats++;
 		}
 	    }
 	  for(unsigned int j = 0; j < fifo[0]->edges.size(); j++)
 	    {
 	      if(fifo[0]->edges[j] == parentFo[0])
 		continue;
+	      if(fifo[0]->edges[j]->layer != layer)
+		continue;
 	      std::vector<Vertex*> currentPath;
 	      currentPath = cycleTron[i];
 	      currentPath.push_back(fifo[0]->edges[j]);
 	      cycleTronNew.push_back(currentPath);
+	      expanded++;
 	      fifo.push_back(fifo[0]->edges[j]);
 	      parentFo.push_back(fifo[0]);
 	      newLevelSize++;
@@ -181,10 +199,16 @@ void Vertex::findCyclesToSelf(int maxCycleSize, std::vector<std::vector<Vertex*>
 	  parentFo.erase(parentFo.begin());
 	  fifo.erase(fifo.begin());
 	}
+      if(memoryEnabled)
+	pathBytes = std::max(pathBytes,nestedBytes(cycleTron) + nestedBytes(cycleTronNew) + vectorBytes(fifo) + vectorBytes(parentFo));
       cycleTron = cycleTronNew;
       cycleTronNew.clear();
       levelSize = newLevelSize;
     }
+  profileCount(PROF_BFS_PATHS,expanded);
+  profileCount(PROF_DUPLICATES,repeats);
+  if(memoryEnabled)
+    memoryNote(MEM_PATHS,pathBytes);
   return;
 }
 
@@ -199,24 +223,17 @@ void Vertex::CountCyclesLocally(int depth,std::vector<std::vector<Vertex*> > &al
 
   this->findCyclesToSelf(depth, allCycles);
   
+  long repeats = 0;
   for(unsigned int i = 0; i < allCycles.size(); i++) //Make sure cycle doesn't go back on itself                            {
     {
-      for(unsigned int j = 0; j < allCycles[i].size(); j++)
-	{ 
-	  bool ifbreak = false;
-	  Vertex* current = (allCycles[i])[j];
-	  for(unsigned int k = 0; k < allCycles[i].size(); k++)
-	    {
-	      if(current == (allCycles[i])[k] && k != j)
-		{
-		  allCycles.erase(allCycles.begin() + i);
-		  i--;
-		  ifbreak = true; break;
-		}
-	    }
-	  if(ifbreak) break;
-	}//j loop over cycle 
+      if(ringHasRepeat(allCycles[i]))
+	{
+	  allCycles.erase(allCycles.begin() + i);
+	  i--;
+	  repeats++;
+	}
     }//i loop over cyclelist 
+  profileCount(PROF_SELF_INTERSECTING,repeats);
   
   //    avoidSuperRing(allCycles); //makes sure none of the big rings are apart of smaller rings. maybe make apart of AddNoRepeats                                                           
   
@@ -13,12 +13,19 @@ class Graph
   
  public:
   Graph();
+  ~Graph();
   std::vector<Vertex*> vertices; 
+  std::vector<Vertex*> bridges;    //atoms contracted out of the graph, still owned by it 
+  void clear(); 
     
   //Ring Counter Routines 
   void FirstSort(std::vector<std::vector<Vertex*> > &allCycles);
   void CountCycles(std::vector<std::vector<Vertex*> >& allCycles);
 
+
+ private:
+  Graph(const Graph&); 
+  Graph& operator=(const Graph&); 
 };
 
 #endif 
@@ -0,0 +1,304 @@
+//graphcache.cpp 
+#include <iostream>
+#include <vector>
+#include <map>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "vertex.h"
+#include "graph.h"
+#include "cell.h"
+#include "sample.h"
+#include "graphcache.h"
+#include "asyncwriter.h"
+#include "log.h"
+
+/*
+  isGraphCache, whether an input file is a graph cache, by its .bgc
+  extension 
+*/
+bool isGraphCache(const char *file)
+{
+  string name = file; 
+  return name.size() > 4 && name.compare(name.size() - 4,4,".bgc") == 0; 
+}//isGraphCache()
+
+/*
+  cacheSize, bytes of a cache with the counts of a header 
+*/
+size_t cacheSize(const GraphCacheHeader &h)
+{
+  size_t words = 7*(size_t)h.nvertices + 1 + 5*(size_t)h.nedges + 5*(size_t)h.nbridges 
+    + h.nrings + 1 + h.nringvertices; 
+  return sizeof(GraphCacheHeader) + 4*words; 
+}//cacheSize()
+
+/*
+  Appends an array to the cache buffer 
+ */
+inline char* cachePut(char *p, const void *data, size_t bytes)
+{
+  if(bytes)
+    memcpy(p,data,bytes); 
+  return p + bytes; 
+}
+
+/*
+  writeGraphCache, writes the bonded graph, its rings and statistics to
+  basename.bgc. The file is assembled in memory and written at once. 
+  @param bilayer, graph after bonding and contraction 
+  @param cell, periodic cell 
+  @param rings, rings of the graph after sorting 
+  @param summary, statistics of the sample 
+  @param nfile, basename of the output files 
+  @return 0 on success, -1 if the file could not be written 
+*/
+int writeGraphCache(Graph &bilayer, const Cell &cell, std::vector<std::vector<Vertex*> > &rings, SampleSummary &summary, string nfile)
+{
+  std::map<Vertex*,int> position; 
+  for(unsigned int i = 0; i < bilayer.vertices.size(); i++)
+    position[bilayer.vertices[i]] = i; 
+  std::map<Vertex*,int> bridge; 
+  for(unsigned int i = 0; i < bilayer.bridges.size(); i++)
+    bridge[bilayer.bridges[i]] = i; 
+
+  GraphCacheHeader h; 
+  memset(&h,0,sizeof(h)); 
+  memcpy(h.magic,"BGC",4); 
+  h.version = GRAPHCACHE_VERSION; 
+  h.headersize = sizeof(GraphCacheHeader); 
+  h.nvertices = bilayer.vertices.size(); 
+  h.nbridges = bilayer.bridges.size(); 
+  h.nrings = rings.size(); 
+  for(int i = 0; i < h.nvertices; i++)
+    h.nedges += bilayer.vertices[i]->edges.size(); 
+  for(int i = 0; i < h.nrings; i++)
+    h.nringvertices += rings[i].size(); 
+  float m[9] = {cell.ax,cell.ay,cell.az,cell.bx,cell.by,cell.bz,cell.cx,cell.cy,cell.cz}; 
+  memcpy(h.cell,m,sizeof(m)); 
+  h.natoms = summary.natoms; 
+  h.nbonds = summary.nbonds; 
+  h.nringstat = summary.nrings; 
+  h.status = summary.status; 
+  h.average = summary.average; 
+  h.mu2 = summary.mu2; 
+  h.bndlength = summary.bndlength; 
+  h.deviation = summary.deviation; 
+  h.arealength = summary.arealength; 
+  h.lewis = summary.lewis; 
+  h.alpha = summary.alpha; 
+
+  std::vector<float> xyz(3*h.nvertices), bxyz(3*h.nbridges); 
+  std::vector<int> index(h.nvertices), atomno(h.nvertices), layer(h.nvertices); 
+  std::vector<int> offset(h.nvertices+1,0), edge(h.nedges), image(3*h.nedges), via(h.nedges); 
+  std::vector<int> bindex(h.nbridges), batomno(h.nbridges); 
+  std::vector<int> roffset(h.nrings+1,0), ring(h.nringvertices); 
+  int e = 0; 
+  for(int i = 0; i < h.nvertices; i++)
+    {
+      Vertex *v = bilayer.vertices[i]; 
+      xyz[3*i] = v->x; 
+      xyz[3*i+1] = v->y; 
+      xyz[3*i+2] = v->z; 
+      index[i] = v->index; 
+      atomno[i] = v->atomno; 
+      layer[i] = v->layer; 
+      for(unsigned int k = 0; k < v->edges.size(); k++, e++)
+	{
+	  std::map<Vertex*,int>::iterator it = position.find(v->edges[k]); 
+	  if(it == position.end())
+	    {
+	      std::cerr << "Edge of vertex " << v->index << " leaves the graph, not cached" << std::endl; 
+	      return -1; 
+	    }
+	  edge[e] = it->second; 
+	  image[3*e] = v->images[k].nx; 
+	  image[3*e+1] = v->images[k].ny; 
+	  image[3*e+2] = v->images[k].nz; 
+	  via[e] = -1; 
+	  if(k < v->bridges.size() && v->bridges[k] != NULL && bridge.count(v->bridges[k]))
+	    via[e] = bridge[v->bridges[k]]; 
+	}
+      offset[i+1] = e; 
+    }
+  for(int i = 0; i < h.nbridges; i++)
+    {
+      Vertex *o = bilayer.bridges[i]; 
+      bxyz[3*i] = o->x; 
+      bxyz[3*i+1] = o->y; 
+      bxyz[3*i+2] = o->z; 
+      bindex[i] = o->index; 
+      batomno[i] = o->atomno; 
+    }
+  int r = 0; 
+  for(int i = 0; i < h.nrings; i++)
+    {
+      for(unsigned int j = 0; j < rings[i].size(); j++)
+	ring[r++] = position[rings[i][j]]; 
+      roffset[i+1] = r; 
+    }
+
+  std::vector<char> buffer(cacheSize(h)); 
+  char *p = &buffer[0]; 
+  p = cachePut(p,&h,sizeof(h)); 
+  p = cachePut(p,xyz.empty() ? NULL : &xyz[0],4*xyz.size()); 
+  p = cachePut(p,index.empty() ? NULL : &index[0],4*index.size()); 
+  p = cachePut(p,atomno.empty() ? NULL : &atomno[0],4*atomno.size()); 
+  p = cachePut(p,layer.empty() ? NULL : &layer[0],4*layer.size()); 
+  p = cachePut(p,&offset[0],4*offset.size()); 
+  p = cachePut(p,edge.empty() ? NULL : &edge[0],4*edge.size()); 
+  p = cachePut(p,image.empty() ? NULL : &image[0],4*image.size()); 
+  p = cachePut(p,via.empty() ? NULL : &via[0],4*via.size()); 
+  p = cachePut(p,bxyz.empty() ? NULL : &bxyz[0],4*bxyz.size()); 
+  p = cachePut(p,bindex.empty() ? NULL : &bindex[0],4*bindex.size()); 
+  p = cachePut(p,batomno.empty() ? NULL : &batomno[0],4*batomno.size()); 
+  p = cachePut(p,&roffset[0],4*roffset.size()); 
+  p = cachePut(p,ring.empty() ? NULL : &ring[0],4*ring.size()); 
+
+  string file = nfile + ".bgc"; 
+  FILE *out = outputOpen(file); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write: " << file << std::endl; 
+      return -1; 
+    }
+  size_t written = fwrite(&buffer[0],1,buffer.size(),out); 
+  outputClose(out); 
+  if(written != buffer.size())
+    {
+      std::cerr << "Short write of " << file << std::endl; 
+      return -1; 
+    }
+  LOG(LOG_INFO) << "Cached " << h.nvertices << " vertices and " << h.nrings << " rings in " << file << std::endl; 
+  return 0; 
+}//writeGraphCache()
+
+/*
+  readGraphCache, maps a graph cache and rebuilds the graph and its
+  rings, so the bonding and the ring search are skipped 
+  @param file, the .bgc file 
+  @param bilayer, graph, filled with the cached vertices and bridges 
+  @param cell, set to the cached cell 
+  @param rings, filled with the cached rings 
+  @param summary, filled with the cached statistics 
+  @return 0 on success, -1 if the file is not a readable cache 
+*/
+int readGraphCache(const char *file, Graph &bilayer, Cell &cell, std::vector<std::vector<Vertex*> > &rings, SampleSummary &summary)
+{
+  int fd = open(file,O_RDONLY); 
+  if(fd < 0)
+    {
+      std::cerr << "Cannot open file: " << file << std::endl; 
+      return -1; 
+    }
+  struct stat st; 
+  if(fstat(fd,&st) != 0 || (size_t)st.st_size < sizeof(GraphCacheHeader))
+    {
+      std::cerr << "Not a graph cache: " << file << std::endl; 
+      close(fd); 
+      return -1; 
+    }
+  void *map = mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0); 
+  close(fd); 
+  if(map == MAP_FAILED)
+    {
+      std::cerr << "Cannot map file: " << file << std::endl; 
+      return -1; 
+    }
+
+  GraphCacheHeader h; 
+  memcpy(&h,map,sizeof(h)); 
+  if(memcmp(h.magic,"BGC",4) != 0 || h.version != GRAPHCACHE_VERSION || h.headersize != (int)sizeof(GraphCacheHeader) 
+     || h.nvertices < 0 || h.nedges < 0 || h.nbridges < 0 || h.nrings < 0 || h.nringvertices < 0 
+     || cacheSize(h) != (size_t)st.st_size)
+    {
+      std::cerr << "Graph cache " << file << " is corrupt or of another version than " << GRAPHCACHE_VERSION << std::endl; 
+      munmap(map,st.st_size); 
+      return -1; 
+    }
+  const float *xyz = (const float*)((const char*)map + sizeof(GraphCacheHeader)); 
+  const int *index = (const int*)(xyz + 3*h.nvertices); 
+  const int *atomno = index + h.nvertices; 
+  const int *layer = atomno + h.nvertices; 
+  const int *offset = layer + h.nvertices; 
+  const int *edge = offset + h.nvertices + 1; 
+  const int *image = edge + h.nedges; 
+  const int *via = image + 3*h.nedges; 
+  const float *bxyz = (const float*)(via + h.nedges); 
+  const int *bindex = (const int*)(bxyz + 3*h.nbridges); 
+  const int *batomno = bindex + h.nbridges; 
+  const int *roffset = batomno + h.nbridges; 
+  const int *ring = roffset + h.nrings + 1; 
+
+  int status = 0; 
+  for(int i = 0; i < h.nvertices; i++)
+    {
+      Vertex *v = new Vertex(atomno[i],xyz[3*i],xyz[3*i+1],xyz[3*i+2]); 
+      v->index = index[i]; 
+      v->layer = layer[i]; 
+      bilayer.vertices.push_back(v); 
+    }
+  for(int i = 0; i < h.nbridges; i++)
+    {
+      Vertex *o = new Vertex(batomno[i],bxyz[3*i],bxyz[3*i+1],bxyz[3*i+2]); 
+      o->index = bindex[i]; 
+      bilayer.bridges.push_back(o); 
+    }
+  //edges are stored in both directions, so they are not added back with AddEdge 
+  for(int i = 0; i < h.nvertices && status == 0; i++)
+    {
+      Vertex *v = bilayer.vertices[i]; 
+      for(int e = offset[i]; e < offset[i+1]; e++)
+	{
+	  if(e < 0 || e >= h.nedges || edge[e] < 0 || edge[e] >= h.nvertices || via[e] >= h.nbridges)
+	    {
+	      status = -1; 
+	      break; 
+	    }
+	  v->edges.push_back(bilayer.vertices[edge[e]]); 
+	  v->images.push_back(Image(image[3*e],image[3*e+1],image[3*e+2])); 
+	  v->bridges.push_back(via[e] >= 0 ? bilayer.bridges[via[e]] : NULL); 
+	}
+    }
+  for(int i = 0; i < h.nrings && status == 0; i++)
+    {
+      std::vector<Vertex*> cycle; 
+      for(int j = roffset[i]; j < roffset[i+1]; j++)
+	{
+	  if(j < 0 || j >= h.nringvertices || ring[j] < 0 || ring[j] >= h.nvertices)
+	    {
+	      status = -1; 
+	      break; 
+	    }
+	  cycle.push_back(bilayer.vertices[ring[j]]); 
+	}
+      rings.push_back(cycle); 
+    }
+  cell = Cell(h.cell[0],h.cell[1],h.cell[2],h.cell[3],h.cell[4],h.cell[5],h.cell[6],h.cell[7],h.cell[8]); 
+  summary.natoms = h.natoms; 
+  summary.nbonds = h.nbonds; 
+  summary.nrings = h.nringstat; 
+  summary.status = h.status; 
+  summary.average = h.average; 
+  summary.mu2 = h.mu2; 
+  summary.bndlength = h.bndlength; 
+  summary.deviation = h.deviation; 
+  summary.arealength = h.arealength; 
+  summary.lewis = h.lewis; 
+  summary.alpha = h.alpha; 
+  munmap(map,st.st_size); 
+
+  if(status != 0)
+    {
+      std::cerr << "Graph cache " << file << " has edges or rings out of range" << std::endl; 
+      return -1; 
+    }
+  LOG(LOG_INFO) << "Graph cache of " << h.nvertices << " vertices, " << h.nedges/2 << " edges and " 
+	    << h.nrings << " rings" << std::endl; 
+  return 0; 
+}//readGraphCache()
@@ -0,0 +1,54 @@
+//graphcache.h 
+#ifndef _GRAPHCACHE_H
+#define _GRAPHCACHE_H
+
+#include <vector>
+#include <string>
+
+#include "graph.h"
+#include "cell.h"
+#include "sample.h"
+
+#define GRAPHCACHE_VERSION 1
+
+/*
+  Header of a binary graph cache, basename.bgc. The header is followed
+  by arrays of 4 byte ints and floats, in order 
+  x y z per vertex, index, atomno and layer per vertex, 
+  the edge offsets (nvertices+1), then per edge the neighbor, the image
+  nx ny nz and the bridge (-1 for none), 
+  x y z, index and atomno per bridge, 
+  the ring offsets (nrings+1) and the vertices of the rings. 
+  Vertices, neighbors and ring vertices are positions in the graph, not
+  the indices of the coordinates file. 
+ */
+struct GraphCacheHeader
+{
+  char magic[4];        //"BGC" 
+  int version; 
+  int headersize; 
+  int nvertices; 
+  int nedges;           //directed, each bond twice 
+  int nbridges; 
+  int nrings; 
+  int nringvertices; 
+  float cell[9]; 
+  int natoms;           //statistics of the sample 
+  int nbonds; 
+  int nringstat; 
+  int status; 
+  int reserved;         //aligns the doubles 
+  double average; 
+  double mu2; 
+  double bndlength; 
+  double deviation; 
+  double arealength; 
+  double lewis; 
+  double alpha; 
+};
+
+bool isGraphCache(const char *file); 
+int writeGraphCache(Graph &bilayer, const Cell &cell, std::vector<std::vector<Vertex*> > &rings, SampleSummary &summary, string nfile); 
+int readGraphCache(const char *file, Graph &bilayer, Cell &cell, std::vector<std::vector<Vertex*> > &rings, SampleSummary &summary); 
+
+#endif 
@@ -0,0 +1,297 @@
+//knnbond.cpp 
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "vertex.h"
+#include "graph.h"
+#include "cell.h"
+#include "knnbond.h"
+#include "profile.h"
+#include "log.h"
+
+static const double PI = 3.14159265358979323846; 
+
+/*
+  Orders points by one coordinate, for the median split of a node 
+ */
+struct KdLess
+{
+  const std::vector<float> *r; 
+  KdLess(const std::vector<float> *rIn) : r(rIn) {}
+  bool operator()(int a, int b) const { return (*r)[a] < (*r)[b]; }
+};
+
+/*
+  kdCoordinates, the coordinate vector of an axis of the tree 
+ */
+static const std::vector<float>& kdCoordinates(const KdTree &tree, int k)
+{
+  return k == 0 ? tree.x : (k == 1 ? tree.y : tree.z); 
+}
+
+/*
+  kdBuild, splits order[lo..hi) at the median of the axis of largest
+  spread, and the two halves in turn 
+*/
+static void kdBuild(KdTree &tree, int lo, int hi)
+{
+  if(hi - lo < 2)
+    return; 
+  float spread[3]; 
+  for(int k = 0; k < 3; k++)
+    {
+      const std::vector<float> &r = kdCoordinates(tree,k); 
+      float rmin = r[tree.order[lo]], rmax = rmin; 
+      for(int i = lo + 1; i < hi; i++)
+	{
+	  rmin = std::min(rmin,r[tree.order[i]]); 
+	  rmax = std::max(rmax,r[tree.order[i]]); 
+	}
+      spread[k] = rmax - rmin; 
+    }
+  int k = 0; 
+  if(spread[1] > spread[k]) k = 1; 
+  if(spread[2] > spread[k]) k = 2; 
+  int mid = (lo + hi)/2; 
+  std::nth_element(tree.order.begin() + lo,tree.order.begin() + mid,tree.order.begin() + hi,KdLess(&kdCoordinates(tree,k))); 
+  tree.axis[mid] = k; 
+  kdBuild(tree,lo,mid); 
+  kdBuild(tree,mid + 1,hi); 
+}//kdBuild()
+
+/*
+  buildKdTree, builds the tree of the vertices and of the images within
+  a margin outside the faces of a periodic cell, so that the nearest
+  neighbors of a vertex wrapped into the cell are found without the
+  minimum image. 
+  @param vertices, the vertices 
+  @param cell, periodic cell 
+  @param margin, distance outside the faces of the cell to keep images,
+  at most half of the cell 
+  @param tree, the tree 
+  @param planar, put the points at z = 0, for the nearest in the plane 
+*/
+void buildKdTree(std::vector<Vertex*> &vertices, const Cell &cell, float margin, KdTree &tree, bool planar)
+{
+  tree = KdTree(); 
+  bool wrap[3] = { cell.periodic(), cell.periodic(), cell.periodicz() }; 
+  float fmargin[3] = { 0, 0, 0 }; 
+  for(int k = 0; k < 3; k++)
+    if(wrap[k])
+      {
+	//width of the cell across the faces of the other two lattice vectors 
+	float l = sqrt(cell.inv[k][0]*cell.inv[k][0] + cell.inv[k][1]*cell.inv[k][1] + cell.inv[k][2]*cell.inv[k][2]); 
+	fmargin[k] = std::min(0.5f,margin*l); 
+      }
+
+  for(unsigned int i = 0; i < vertices.size(); i++)
+    {
+      Vertex *v = vertices[i]; 
+      float f[3] = { 0, 0, 0 }; 
+      int base[3] = { 0, 0, 0 }; 
+      cellFractional(cell,v->x,v->y,v->z,f[0],f[1],f[2]); 
+      for(int k = 0; k < 3; k++)
+	if(wrap[k])
+	  {
+	    base[k] = -(int)floor(f[k]); 
+	    f[k] += base[k]; 
+	  }
+      int lo[3], hi[3]; 
+      for(int k = 0; k < 3; k++)
+	{
+	  lo[k] = (wrap[k] && f[k] > 1 - fmargin[k]) ? -1 : 0; 
+	  hi[k] = (wrap[k] && f[k] < fmargin[k]) ? 1 : 0; 
+	}
+      for(int a = lo[0]; a <= hi[0]; a++)
+	for(int b = lo[1]; b <= hi[1]; b++)
+	  for(int c = lo[2]; c <= hi[2]; c++)
+	    {
+	      Image image(base[0] + a,base[1] + b,base[2] + c); 
+	      float sx, sy, sz; 
+	      cellShift(cell,image,sx,sy,sz); 
+	      tree.x.push_back(v->x + sx); 
+	      tree.y.push_back(v->y + sy); 
+	      tree.z.push_back(planar ? 0 : v->z + sz); 
+	      tree.vertex.push_back(i); 
+	      tree.image.push_back(image); 
+	    }
+    }
+  tree.order.resize(tree.x.size()); 
+  for(unsigned int p = 0; p < tree.order.size(); p++)
+    tree.order[p] = p; 
+  tree.axis.assign(tree.order.size(),0); 
+  kdBuild(tree,0,tree.order.size()); 
+}//buildKdTree()
+
+/*
+  kdSearch, adds the points of order[lo..hi) closer than the farthest
+  of the nearest found so far 
+*/
+static void kdSearch(const KdTree &tree, int lo, int hi, const float q[3], unsigned int k, std::vector<std::pair<float,int> > &nearest)
+{
+  if(lo >= hi)
+    return; 
+  int mid = (lo + hi)/2; 
+  int p = tree.order[mid]; 
+  float dx = tree.x[p] - q[0], dy = tree.y[p] - q[1], dz = tree.z[p] - q[2]; 
+  float r2 = dx*dx + dy*dy + dz*dz; 
+  if(nearest.size() < k || r2 < nearest.back().first)
+    {
+      std::pair<float,int> found(r2,p); 
+      nearest.insert(std::upper_bound(nearest.begin(),nearest.end(),found),found); 
+      if(nearest.size() > k)
+	nearest.pop_back(); 
+    }
+  int axis = tree.axis[mid]; 
+  float d = q[axis] - kdCoordinates(tree,axis)[p]; 
+  if(d < 0)
+    {
+      kdSearch(tree,lo,mid,q,k,nearest); 
+      if(nearest.size() < k || d*d < nearest.back().first)
+	kdSearch(tree,mid + 1,hi,q,k,nearest); 
+    }
+  else
+    {
+      kdSearch(tree,mid + 1,hi,q,k,nearest); 
+      if(nearest.size() < k || d*d < nearest.back().first)
+	kdSearch(tree,lo,mid,q,k,nearest); 
+    }
+}//kdSearch()
+
+/*
+  kdNearest, the k points of the tree nearest to a point 
+  @param tree, the tree 
+  @param x, y, z the point 
+  @param k, number of points 
+  @param nearest, squared distance and point of the k nearest, nearest first
+*/
+void kdNearest(const KdTree &tree, float x, float y, float z, unsigned int k, std::vector<std::pair<float,int> > &nearest)
+{
+  nearest.clear(); 
+  float q[3] = { x, y, z }; 
+  kdSearch(tree,0,tree.order.size(),q,k,nearest); 
+}//kdNearest()
+
+/*
+  A bond proposed by the nearest neighbor search, to an image of a vertex 
+ */
+struct Candidate
+{
+  int j; 
+  Image image; 
+  float dx, dy, dz; 
+};
+
+/*
+  hasCandidate, whether a list of candidates holds an image of a vertex 
+*/
+static bool hasCandidate(const std::vector<Candidate> &list, int j, Image image)
+{
+  for(unsigned int c = 0; c < list.size(); c++)
+    if(list[c].j == j && list[c].image.nx == image.nx && list[c].image.ny == image.ny && list[c].image.nz == image.nz)
+      return true; 
+  return false; 
+}//hasCandidate()
+
+/*
+  connectNearest, bonds each silicon to its k nearest silicons found with
+  a k-d tree, for noisy coordinates that no single bond length fits. A
+  bond is kept if each end is among the k nearest of the other, and if
+  it makes at least minangle with the shorter bonds kept at both ends.
+  Periodic images near the faces of the cell are in the tree, the
+  margin is four times the mean spacing of the silicons. Oxygens are
+  left unbonded. 
+  @param bilayer, graph of the sample 
+  @param k, nearest neighbors of each silicon 
+  @param minangle, smallest angle between two bonds of a silicon, in degrees 
+  @param cell, periodic cell 
+  @return the number of bonds 
+*/
+int connectNearest(Graph &bilayer, int k, float minangle, const Cell &cell)
+{
+  std::vector<Vertex*> silicons; 
+  for(unsigned int i = 0; i < bilayer.vertices.size(); i++)
+    if(bilayer.vertices[i]->atomno != 8)
+      silicons.push_back(bilayer.vertices[i]); 
+  int n = silicons.size(); 
+  if(n < 2 || k < 1)
+    return 0; 
+
+  float margin = 0; 
+  if(cell.periodic())
+    {
+      float area = fabs(cell.det()); 
+      margin = 4*sqrt(area/n); 
+    }
+  KdTree tree; 
+  buildKdTree(silicons,cell,margin,tree); 
+
+  //k nearest of each silicon wrapped into the cell, images relative to
+  //the silicon where it is 
+  std::vector<std::vector<Candidate> > nearest(n); 
+  std::vector<std::pair<float,int> > found; 
+  for(int i = 0; i < n; i++)
+    {
+      Vertex *v = silicons[i]; 
+      float fa = 0, fb = 0, fc = 0; 
+      cellFractional(cell,v->x,v->y,v->z,fa,fb,fc); 
+      Image base(cell.periodic() ? -(int)floor(fa) : 0,cell.periodic() ? -(int)floor(fb) : 0,cell.periodicz() ? -(int)floor(fc) : 0); 
+      float sx, sy, sz; 
+      cellShift(cell,base,sx,sy,sz); 
+      kdNearest(tree,v->x + sx,v->y + sy,v->z + sz,k + 1,found); 
+      for(unsigned int f = 0; f < found.size() && (int)nearest[i].size() < k; f++)
+	{
+	  int p = found[f].second; 
+	  Candidate c; 
+	  c.j = tree.vertex[p]; 
+	  c.image = tree.image[p] + (-base); 
+	  if(c.j == i || hasCandidate(nearest[i],c.j,c.image))
+	    continue; 
+	  c.dx = tree.x[p] - (v->x + sx); 
+	  c.dy = tree.y[p] - (v->y + sy); 
+	  c.dz = tree.z[p] - (v->z + sz); 
+	  nearest[i].push_back(c); 
+	}
+    }
+
+  //mutual neighbors, then the angle with the shorter bonds kept 
+  float mincos = cos(minangle*PI/180); 
+  std::vector<std::vector<Candidate> > kept(n); 
+  for(int i = 0; i < n; i++)
+    {
+      for(unsigned int c = 0; c < nearest[i].size(); c++)
+	{
+	  const Candidate &b = nearest[i][c]; 
+	  if(!hasCandidate(nearest[b.j],i,-b.image))
+	    continue; 
+	  float lb = sqrt(b.dx*b.dx + b.dy*b.dy + b.dz*b.dz); 
+	  bool open = true; 
+	  for(unsigned int a = 0; a < kept[i].size() && open; a++)
+	    {
+	      const Candidate &o = kept[i][a]; 
+	      float lo = sqrt(o.dx*o.dx + o.dy*o.dy + o.dz*o.dz); 
+	      open = (b.dx*o.dx + b.dy*o.dy + b.dz*o.dz) < mincos*lb*lo; 
+	    }
+	  if(open)
+	    kept[i].push_back(b); 
+	  else
+	    LOG(LOG_DEBUG) << "Bond " << silicons[i]->index << " " << silicons[b.j]->index << " closes too small an angle" << std::endl; 
+	}
+    }
+
+  int nbonds = 0; 
+  for(int i = 0; i < n; i++)
+    for(unsigned int c = 0; c < kept[i].size(); c++)
+      {
+	const Candidate &b = kept[i][c]; 
+	if(b.j < i || !hasCandidate(kept[b.j],i,-b.image) || silicons[i]->EdgeIndex(silicons[b.j]) >= 0)
+	  continue; 
+	silicons[i]->AddEdge(silicons[b.j],b.image); 
+	nbonds++; 
+      }
+  profileCount(PROF_DISTANCE_BONDS,nbonds); 
+  LOG(LOG_INFO) << "Bonded " << nbonds << " nearest neighbor pairs of " << n << " silicons" << std::endl; 
+  return nbonds; 
+}//connectNearest()
@@ -0,0 +1,31 @@
+//knnbond.h 
+#ifndef _KNNBOND_H
+#define _KNNBOND_H
+
+#include <vector>
+#include <utility>
+
+#include "vertex.h"
+#include "graph.h"
+#include "cell.h"
+
+/*
+  k-d tree of a set of vertices and of their periodic images near the
+  faces of the cell. Point p is the image image[p] of vertex[p]. The
+  tree is implicit in order: the node of order[lo..hi) has its split
+  point at the middle and the split axis in axis[middle]. 
+ */
+struct KdTree
+{
+  std::vector<float> x, y, z; 
+  std::vector<int> vertex; 
+  std::vector<Image> image; 
+  std::vector<int> order; 
+  std::vector<char> axis; 
+};
+
+void buildKdTree(std::vector<Vertex*> &vertices, const Cell &cell, float margin, KdTree &tree, bool planar = false); 
+void kdNearest(const KdTree &tree, float x, float y, float z, unsigned int k, std::vector<std::pair<float,int> > &nearest); 
+int connectNearest(Graph &bilayer, int k, float minangle, const Cell &cell); 
+
+#endif 
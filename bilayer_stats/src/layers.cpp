@@ -0,0 +1,172 @@
+//layers.cpp 
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "vertex.h"
+#include "graph.h"
+#include "cell.h"
+#include "layers.h"
+#include "knnbond.h"
+#include "asyncwriter.h"
+#include "log.h"
+
+/*
+  Orders vertices by height 
+ */
+bool lowerVertex(const Vertex *a, const Vertex *b)
+{
+  return a->z < b->z; 
+}
+
+/*
+  classifyLayers, splits the vertices in two sheets by height. The split
+  minimizes the spread of z within the sheets (two cluster k-means in
+  one dimension, exact on the sorted heights). The split is only taken
+  when the sheets are further apart than their thickness, otherwise the
+  sample is a single layer. Sets the layer of every vertex. 
+  @param bilayer, graph 
+  @param layers, filled with a view of each layer, bottom first 
+  @return the number of layers, 1 or 2 
+*/
+int classifyLayers(Graph &bilayer, std::vector<LayerView> &layers)
+{
+  std::vector<Vertex*> sorted = bilayer.vertices; 
+  std::sort(sorted.begin(),sorted.end(),lowerVertex); 
+  int n = sorted.size(); 
+  layers.clear(); 
+
+  //prefix sums of z and z^2 give the spread of each split in O(1)
+  std::vector<double> sz(n+1,0.0), szz(n+1,0.0); 
+  for(int i = 0; i < n; i++)
+    {
+      sz[i+1] = sz[i] + sorted[i]->z; 
+      szz[i+1] = szz[i] + (double)sorted[i]->z*sorted[i]->z; 
+    }
+  int split = 0; 
+  double best = 0; 
+  for(int k = 1; k < n; k++)
+    {
+      double low = szz[k] - sz[k]*sz[k]/k; 
+      double high = (szz[n] - szz[k]) - (sz[n] - sz[k])*(sz[n] - sz[k])/(n - k); 
+      if(k == 1 || low + high < best)
+	{
+	  best = low + high; 
+	  split = k; 
+	}
+    }
+
+  bool bilayered = false; 
+  if(split > 0)
+    {
+      double zlow = sz[split]/split; 
+      double zhigh = (sz[n] - sz[split])/(n - split); 
+      double thick = sorted[split-1]->z - sorted[0]->z; 
+      if(sorted[n-1]->z - sorted[split]->z > thick)
+	thick = sorted[n-1]->z - sorted[split]->z; 
+      bilayered = sorted[split]->z - sorted[split-1]->z > thick; 
+      LOG(LOG_INFO) << "Layers at z = " << zlow << " and " << zhigh << ", gap " 
+		<< sorted[split]->z - sorted[split-1]->z << " thickness " << thick << std::endl; 
+    }
+  if(!bilayered)
+    {
+      LOG(LOG_INFO) << "No separate layers, analyzing a single layer" << std::endl; 
+      split = n; 
+    }
+
+  int nlayers = bilayered ? 2 : 1; 
+  layers.resize(nlayers); 
+  for(int l = 0; l < nlayers; l++)
+    {
+      layers[l].layer = l; 
+      layers[l].z = 0; 
+      layers[l].name = nlayers == 1 ? "" : (l == 0 ? "_bottom" : "_top"); 
+    }
+  //views keep the order of the graph so the vertex indices stay sorted 
+  for(unsigned int i = 0; i < bilayer.vertices.size(); i++)
+    {
+      Vertex *v = bilayer.vertices[i]; 
+      v->layer = (nlayers == 2 && v->z >= sorted[split]->z) ? 1 : 0; 
+      layers[v->layer].vertices.push_back(v); 
+      layers[v->layer].z += v->z; 
+    }
+  for(int l = 0; l < nlayers; l++)
+    if(!layers[l].vertices.empty())
+      layers[l].z /= layers[l].vertices.size(); 
+  return nlayers; 
+}//classifyLayers()
+
+/*
+  layerRegistration, how well the two sheets are stacked. For every
+  vertex of the top layer finds the nearest vertex of the bottom layer
+  in the plane, with the minimum image in a periodic box, from a k-d
+  tree of the bottom layer flattened to z = 0. 
+  @param top, bottom, the layers 
+  @param cell, periodic cell 
+  @param reg, filled with the offsets 
+*/
+void layerRegistration(LayerView &top, LayerView &bottom, const Cell &cell, Registration &reg)
+{
+  reg = Registration(); 
+  if(bottom.vertices.empty())
+    return; 
+  //images up to half the cell outside its faces, as far as the minimum image reaches 
+  KdTree tree; 
+  buildKdTree(bottom.vertices,cell,1e30,tree,true); 
+  std::vector<std::pair<float,int> > found; 
+  double sum = 0., sum2 = 0.; 
+  for(unsigned int i = 0; i < top.vertices.size(); i++)
+    {
+      //the top vertex wrapped into the cell, as the points of the tree 
+      Vertex *t = top.vertices[i]; 
+      float fa = 0, fb = 0, fc = 0; 
+      cellFractional(cell,t->x,t->y,t->z,fa,fb,fc); 
+      Image base(cell.periodic() ? -(int)floor(fa) : 0,cell.periodic() ? -(int)floor(fb) : 0,cell.periodicz() ? -(int)floor(fc) : 0); 
+      float sx, sy, sz; 
+      cellShift(cell,base,sx,sy,sz); 
+      kdNearest(tree,t->x + sx,t->y + sy,0,1,found); 
+      Vertex *b = bottom.vertices[tree.vertex[found[0].second]]; 
+      float dx = t->x - b->x; 
+      float dy = t->y - b->y; 
+      float dz = 0; 
+      cellMinimumVector(cell,dx,dy,dz); 
+      float r = sqrt(dx*dx + dy*dy); 
+      reg.top.push_back(t->index); 
+      reg.bottom.push_back(b->index); 
+      reg.dx.push_back(dx); 
+      reg.dy.push_back(dy); 
+      sum += r; 
+      sum2 += r*r; 
+      if(r > reg.max)
+	reg.max = r; 
+    }
+  if(!reg.top.empty())
+    {
+      reg.mean = sum/reg.top.size(); 
+      reg.rms = sqrt(sum2/reg.top.size()); 
+    }
+}//layerRegistration()
+
+/*
+  registrationOut, offset of each top vertex from its bottom partner 
+  @param reg, offsets from layerRegistration 
+  @param nfile, basename of the output file 
+*/
+void registrationOut(Registration &reg, string nfile)
+{
+  FILE *out; 
+  out = outputOpen(nfile+"_registration.dat"); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write" << std::endl; 
+      return; 
+    }
+  fprintf(out,"#mean %f rms %f max %f\n",reg.mean,reg.rms,reg.max); 
+  fprintf(out,"#top bottom dx dy\n"); 
+  for(unsigned int i = 0; i < reg.top.size(); i++)
+    fprintf(out,"%d %d %f %f\n",reg.top[i],reg.bottom[i],reg.dx[i],reg.dy[i]); 
+  outputClose(out); 
+  LOG(LOG_INFO) << "Layer registration offset mean " << reg.mean << " rms " << reg.rms << " max " << reg.max << std::endl; 
+}//registrationOut()
@@ -0,0 +1,44 @@
+//layers.h 
+#ifndef _LAYERS_H
+#define _LAYERS_H
+
+#include <vector>
+#include <string>
+
+#include "vertex.h"
+#include "graph.h"
+#include "cell.h"
+
+/*
+  One sheet of a bilayer. The vertices point into the graph of the
+  whole sample, the layer is a view and not a copy. 
+ */
+struct LayerView
+{
+  int layer; 
+  float z;                        //mean height 
+  string name; 
+  std::vector<Vertex*> vertices; 
+};
+
+/*
+  Offset of each vertex of the top layer from the nearest vertex of the
+  bottom layer in the plane 
+ */
+struct Registration
+{
+  std::vector<int> top; 
+  std::vector<int> bottom; 
+  std::vector<float> dx; 
+  std::vector<float> dy; 
+  double mean; 
+  double rms; 
+  float max; 
+  Registration() : mean(0), rms(0), max(0) {}
+};
+
+int classifyLayers(Graph &bilayer, std::vector<LayerView> &layers); 
+void layerRegistration(LayerView &top, LayerView &bottom, const Cell &cell, Registration &reg); 
+void registrationOut(Registration &reg, string nfile="bilayer"); 
+
+#endif 
@@ -0,0 +1,144 @@
+//leiden.cpp 
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "vertex.h"
+#include "graph.h"
+#include "cell.h"
+#include "leiden.h"
+#include "log.h"
+
+/*
+  isLeiden, whether a coordinates file is a Leiden network, by its
+  .coord extension 
+*/
+bool isLeiden(const char *file)
+{
+  string name = file; 
+  return name.size() > 6 && name.compare(name.size() - 6,6,".coord") == 0; 
+}//isLeiden()
+
+/*
+  leidenConnect, connectivity file that goes with a Leiden coordinates
+  file, the same name with the .connect extension 
+*/
+string leidenConnect(const char *coordfile)
+{
+  string name = coordfile; 
+  return name.substr(0,name.size() - 6) + ".connect"; 
+}//leidenConnect()
+
+/*
+  leidenHeader, reads a # line of the header of a Leiden file 
+  @param line, the line 
+  @param cell, set from the e_i and e_j lattice vectors 
+  @param nvertices, set from the nvertices line 
+*/
+void leidenHeader(const char *line, Cell &cell, int &nvertices)
+{
+  float u, v; 
+  if(sscanf(line,"#nvertices:%d",&nvertices) == 1)
+    return; 
+  if(sscanf(line,"#e_i=(%f,%f)",&u,&v) == 2)
+    {
+      cell.ax = u; 
+      cell.ay = v; 
+      cell.init(); 
+    }
+  else if(sscanf(line,"#e_j=(%f,%f)",&u,&v) == 2)
+    {
+      cell.bx = u; 
+      cell.by = v; 
+      cell.init(); 
+    }
+}//leidenHeader()
+
+/*
+  read_leiden, reads a Leiden network, the .coord file of x y per vertex
+  and the .connect file of a vertex followed by its neighbors per line.
+  Both start with a # header giving the number of vertices and the
+  lattice vectors e_i and e_j. The bonds go to the nearest image in the
+  cell. 
+  @param coordfile, coordinates file 
+  @param connectfile, connectivity file 
+  @param bilayer, graph 
+  @param cell, set from the header 
+  @return 0 on success, -1 if the files could not be read 
+*/
+int read_leiden(const char *coordfile, const char *connectfile, Graph &bilayer, Cell &cell)
+{
+  char line[1024]; 
+  int nvertices = -1; 
+  FILE *in; 
+  in = fopen(coordfile,"r"); 
+  if(in == NULL)
+    {
+      std::cerr << "Cannot open file: " << coordfile << std::endl; 
+      return -1; 
+    }
+  while(fgets(line,sizeof(line),in))
+    {
+      float x, y; 
+      if(line[0] == '#')
+	leidenHeader(line,cell,nvertices); 
+      else if(sscanf(line,"%f %f",&x,&y) == 2)
+	bilayer.vertices.push_back(new Vertex(14,x,y,0.0)); 
+    }
+  fclose(in); 
+  for(unsigned int i = 0; i < bilayer.vertices.size(); i++)
+    bilayer.vertices[i]->index = i; 
+  int natoms = bilayer.vertices.size(); 
+  if(natoms == 0 || (nvertices >= 0 && nvertices != natoms))
+    {
+      std::cerr << "Read " << natoms << " vertices of " << nvertices << " from: " << coordfile << std::endl; 
+      return -1; 
+    }
+  LOG(LOG_INFO) << "Leiden network of " << natoms << " vertices, e_i = (" << cell.ax << "," << cell.ay 
+	    << ") e_j = (" << cell.bx << "," << cell.by << ")" << std::endl; 
+
+  Cell header; 
+  in = fopen(connectfile,"r"); 
+  if(in == NULL)
+    {
+      std::cerr << "Cannot open file: " << connectfile << std::endl; 
+      return -1; 
+    }
+  int nbonds = 0; 
+  while(fgets(line,sizeof(line),in))
+    {
+      if(line[0] == '#')
+	{
+	  leidenHeader(line,header,nvertices); 
+	  continue; 
+	}
+      //strtok_r, the samples of a batch are read concurrently 
+      char *save; 
+      char *token = strtok_r(line," \t\n",&save); 
+      if(token == NULL)
+	continue; 
+      int i = atoi(token); 
+      while((token = strtok_r(NULL," \t\n",&save)) != NULL)
+	{
+	  int j = atoi(token); 
+	  if(i < 0 || j < 0 || i >= natoms || j >= natoms)
+	    {
+	      std::cerr << "Connection " << i << " " << j << " is out of range of the " << natoms << " vertices" << std::endl; 
+	      fclose(in); 
+	      return -1; 
+	    }
+	  Vertex *vi = bilayer.vertices[i], *vj = bilayer.vertices[j]; 
+	  if(vi->EdgeIndex(vj) >= 0)
+	    continue; 
+	  vi->AddEdge(vj,cellMinimumImage(cell,vj->x - vi->x,vj->y - vi->y,vj->z - vi->z)); 
+	  nbonds++; 
+	}
+    }
+  fclose(in); 
+  if(header.ax != cell.ax || header.ay != cell.ay || header.bx != cell.bx || header.by != cell.by)
+    std::cerr << "Lattice vectors of " << connectfile << " differ from " << coordfile << std::endl; 
+  LOG(LOG_DEBUG) << "Number of Leiden connections: " << nbonds << std::endl; 
+  return 0; 
+}//read_leiden()
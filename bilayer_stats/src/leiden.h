@@ -0,0 +1,14 @@
+//leiden.h 
+#ifndef _LEIDEN_H
+#define _LEIDEN_H
+
+#include <string>
+
+#include "graph.h"
+#include "cell.h"
+
+bool isLeiden(const char *file); 
+string leidenConnect(const char *coordfile); 
+int read_leiden(const char *coordfile, const char *connectfile, Graph &bilayer, Cell &cell); 
+
+#endif 
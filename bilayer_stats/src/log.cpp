@@ -0,0 +1,41 @@
+//log.cpp
+#include <iostream>
+#include <cstring>
+
+#include "log.h"
+
+/*
+  Level of the messages printed at runtime, set by --log, --quiet and
+  --verbose
+ */
+int logLevel = LOG_INFO;
+
+/*
+  Name of each level in --log
+ */
+static const char *logNames[] = { "error", "warn", "info", "debug" };
+
+/*
+  parseLogLevel, reads the name of a level
+  @param name, error, warn, info or debug
+  @return the level, -1 if the name is not a level
+*/
+int parseLogLevel(const char *name)
+{
+  for(int i = LOG_ERROR; i <= LOG_DEBUG; i++)
+    if(strcmp(name,logNames[i]) == 0)
+      return i;
+  return -1;
+}//parseLogLevel()
+
+/*
+  logStream, stream of the messages of a level, errors and warnings go
+  to std::cerr and the rest to std::cout
+  @param level, level of the message
+*/
+std::ostream& logStream(int level)
+{
+  if(level <= LOG_WARN)
+    return std::cerr << (level == LOG_ERROR ? "Error: " : "Warning: ");
+  return std::cout;
+}//logStream()
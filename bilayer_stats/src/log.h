@@ -0,0 +1,46 @@
+//log.h
+#ifndef _LOG_H
+#define _LOG_H
+
+#include <iostream>
+
+/*
+  Levels of the log messages, from the most to the least important
+ */
+enum LogLevel
+{
+  LOG_ERROR,            //failures
+  LOG_WARN,             //suspicious input or options
+  LOG_INFO,             //concise summary of each sample
+  LOG_DEBUG             //progress, parameters and details of vertices and rings
+};
+
+/*
+  Messages above LOG_MAX_LEVEL are compiled away, build with
+  -DLOG_MAX_LEVEL=3 to keep the debug messages
+ */
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL LOG_INFO
+#endif
+
+extern int logLevel;
+
+int parseLogLevel(const char *name);
+std::ostream& logStream(int level);
+
+/*
+  logEnabled, whether a message of a level is printed, constant for the
+  levels compiled away
+ */
+inline bool logEnabled(int level)
+{
+  return level <= LOG_MAX_LEVEL && level <= logLevel;
+}
+
+/*
+  LOG(level) << ...; prints a message of a level, the message is only
+  evaluated if the level is enabled
+ */
+#define LOG(level) for(bool logOnce = logEnabled(level); logOnce; logOnce = false) logStream(level)
+
+#endif
@@ -6,6 +6,8 @@
 #include <vector>
 #include <cmath>
 #include <cassert>
+#include <pthread.h>
+#include <unistd.h>
 
 #include "vertex.h"
 #include "graph.h"
@@ -13,57 +15,65 @@
 #include "testcases.h"
 #include "tinyxml2.h"
 #include "aboav.h"
-
-//global variables 
-Graph bilayer; 
-std::vector<std::vector<Vertex*> > allCycles;
-std::vector<std::vector<Vertex*> > sortedCycles; 
-const int ringmax = 12; 
-int countBucket[ringmax];
-double aboavBucket[ringmax]; 
-std::vector<std::vector<double> > aboavStack; 
-float areaBucket[ringmax]; 
-std::vector<std::vector<int> > stack; 
+#include "sample.h"
+#include "batch.h"
+#include "ringkernel.h"
+#include "ringgeom.h"
+#include "bondstats.h"
+#include "fitting.h"
+#include "layers.h"
+#include "bridges.h"
+#include "cell.h"
+#include "leiden.h"
+#include "graphcache.h"
+#include "npyout.h"
+#include "render.h"
+#include "threadbudget.h"
+#include "resultcache.h"
+#include "outbuffer.h"
+#include "asyncwriter.h"
+#include "profile.h"
+#include "log.h"
+#include "knnbond.h"
+#include "pdf.h"
 
 /*
   read_xyz: reads a file in the xyz format omiting oxygen 
   atoms  
   @param: file, xyz file 
+  @return: 0 on success, -1 if the file could not be read
 */
-void read_xyz(char *file, Graph &bilayer,bool Debug=false)
+int read_xyz(const char *file, Graph &bilayer)
 {
   int numatoms;
-  char buffer[3];
-  char atom[2]; 
+  char buffer[256];
+  char atom[8]; 
   float x,y,z;
   FILE *in; 
   in = fopen(file,"r");
   if(in == NULL)
     {
       std::cerr << "Cannot open file: " << file << std::endl; 
-      exit(1);
+      return -1;
     }
-  if(fscanf(in, "%d", &numatoms))
+  if(1 == fscanf(in, "%d", &numatoms))
     {
-      std::cout << "Number of atoms: " << numatoms << std::endl; 
+      LOG(LOG_INFO) << "Number of atoms: " << numatoms << std::endl; 
     }
   else
     {
-      std::cerr << "ERROR reading number of atoms" << std::endl; exit(1); 
+      std::cerr << "ERROR reading number of atoms" << std::endl; 
+      fclose(in); 
+      return -1; 
     }
 
-  if(fscanf(in, "%s\n",buffer))
+  if(fscanf(in, "%255s\n",buffer))
     
 
-  if(Debug)
-    {
-      printf("%d\n",numatoms);
-      printf("%s\n",buffer);
-    }
-  while(4 == fscanf(in,"%s %f %f %f\n",atom,&x,&y,&z) )
+  LOG(LOG_DEBUG) << numatoms << std::endl << buffer << std::endl; 
+  while(4 == fscanf(in,"%7s %f %f %f\n",atom,&x,&y,&z) )
     {
-      if(Debug)
-	printf("%s %.15f %.15f %.15f\n",atom,x,y,z);
+      LOG(LOG_DEBUG) << atom << " " << x << " " << y << " " << z << std::endl; 
       if (atom[0] == 'O')
 	{
 	  //continue;
@@ -80,34 +90,56 @@ void read_xyz(char *file, Graph &bilayer,bool Debug=false)
   
   for(unsigned int i = 0; i < bilayer.vertices.size(); i++)
     bilayer.vertices[i]->index = i; 
+
+  if(bilayer.vertices.empty())
+    {
+      std::cerr << "No atoms read from: " << file << std::endl; 
+      return -1; 
+    }
+  return 0; 
   
 }//read_xyz()
 
-void read_connect(char *file, Graph &bilayer)
+/*
+  read_connect: reads the manual connectivity table, bonding each pair
+  to the nearest periodic image
+  @param: file, con file 
+  @param: cell, periodic cell 
+  @return: 0 on success, -1 if the table is unreadable or inconsistent
+*/
+int read_connect(const char *file, Graph &bilayer, const Cell &cell)
 {
   FILE *in; 
   int i,j,nconnect, nconcount=0; 
+  int natoms = bilayer.vertices.size(); 
 
   in = fopen(file,"r"); 
   if( NULL == in )
     {
       std::cerr << "Cannot open file: " << file << std::endl; 
-      exit(1); 
+      return -1; 
     }
-  if(fscanf(in,"%d",&nconnect)) 
+  if(1 == fscanf(in,"%d",&nconnect)) 
     {
-      std::cout << "Number of manual connections: " << nconnect << std::endl; 
+      LOG(LOG_DEBUG) << "Number of manual connections: " << nconnect << std::endl; 
     }
   else
     {
       std::cerr << "Error reading number of connections" << std::endl; 
-      exit(1); 
+      fclose(in); 
+      return -1; 
     }
 
   while( 2 == fscanf(in,"%d %d\n",&i,&j) )
     {
       //std::cout << "Making connection between i: " << i << " and j: " << j << std::endl; 
-      bilayer.vertices[i]->AddEdge(bilayer.vertices[j]); 
+      if(i < 0 || j < 0 || i >= natoms || j >= natoms)
+	{
+	  std::cerr << "Connection " << i << " " << j << " is out of range of the " << natoms << " atoms" << std::endl; 
+	  fclose(in); 
+	  return -1; 
+	}
+      bilayer.vertices[i]->AddPeriodicEdge(bilayer.vertices[j],cell); 
       nconcount++; 
     }
   fclose(in); 
@@ -115,62 +147,67 @@ void read_connect(char *file, Graph &bilayer)
   if( nconnect != nconcount)
     {
       std::cerr << "The number of connections: " << nconnect << " . Does not match the number read: " << nconcount << std::endl;
-      exit(1); 
+      return -1; 
     }
-
+  return 0; 
 
 }//read_connect()
 
 
 /*
-  Connect atoms within a certain distance 
+  Connect atoms within a certain distance of the nearest periodic image 
+  @param cell, periodic cell 
  */
-void connectAtoms(Graph &bilayer,float dist,int Debug=0)
+void connectAtoms(Graph &bilayer,float dist,const Cell &cell)
 {
+  long nbonds = 0; 
   
   for(unsigned int i = 0; i < bilayer.vertices.size(); i++)
     {
       for(unsigned int j = i+1; j < bilayer.vertices.size(); j++)
 	{
-	  float x_ij = bilayer.vertices[i]->x - bilayer.vertices[j]->x; 
-	  float y_ij = bilayer.vertices[i]->y - bilayer.vertices[j]->y;
-	  float z_ij = bilayer.vertices[i]->z - bilayer.vertices[j]->z;
+	  Image image = bilayer.vertices[i]->MinimumImage(bilayer.vertices[j],cell); 
+	  float sx, sy, sz; 
+	  cellShift(cell,image,sx,sy,sz); 
+	  float x_ij = bilayer.vertices[i]->x - (bilayer.vertices[j]->x + sx); 
+	  float y_ij = bilayer.vertices[i]->y - (bilayer.vertices[j]->y + sy);
+	  float z_ij = bilayer.vertices[i]->z - (bilayer.vertices[j]->z + sz);
 	  float r = sqrt( x_ij*x_ij + y_ij*y_ij + z_ij*z_ij ); 
 	  
-	  if(Debug)
+	  LOG(LOG_DEBUG) << "Vertex: " << i << " " << bilayer.vertices[i]->x << " " << bilayer.vertices[i]->y << " " << bilayer.vertices[i]->z << std::endl 
+			 << "Vertex: " << j << " " << bilayer.vertices[j]->x << " " << bilayer.vertices[j]->y << " " << bilayer.vertices[j]->z << std::endl 
+			 << "x_ij " << x_ij << " y_ij " << y_ij << " z_ij " << z_ij << " r: " << r << std::endl; 
+	  if(r > 0.0 && r < dist)
 	    {
-	      std::cout << "Vertex: " << i << " " << bilayer.vertices[i]->x << " " << bilayer.vertices[i]->y << " " << bilayer.vertices[i]->z << std::endl; 
-	      std::cout << "Vertex: " << j << " " << bilayer.vertices[j]->x << " " << bilayer.vertices[j]->y << " " << bilayer.vertices[j]->z << std::endl; 
-	      std::cout << "x_ij " << x_ij << std::endl; 
-	      std::cout << "y_ij " << y_ij << std::endl; 
-	      std::cout << "z_ij " << z_ij << std::endl; 
-	      std::cout << "r: " << r << std::endl; 
-	      
+	      bilayer.vertices[i]->AddEdge(bilayer.vertices[j],image); 
+	      nbonds++; 
 	    }
-	  if(r > 0.0 && r < dist)
-	    bilayer.vertices[i]->AddEdge(bilayer.vertices[j]); 
 	    
 
 	}//j loop 
     }//i loop
+  profileCount(PROF_DISTANCE_BONDS,nbonds); 
 }//connectatoms
 
 /*
-  MakeHoney, Output coordinates to be visualized in Mathematica
+  MakeHoney, Output coordinates to be visualized in Mathematica. Edges
+  that wrap around the periodic box are not drawn. 
   @param bilayer, Graph object containing vertices 
   @param nfile, array of characters for name of output file
  */
-void MakeHoney(Graph& bilayer, string nfile="bilayer", float rmax =10.0)
+void MakeHoney(Graph& bilayer, string nfile="bilayer")
 {
   FILE *outFile; 
   string extm="_structure.m"; 
   string extpdf = "_structure.pdf";
   string file = nfile + extm; 
-  float xdist = 0.0; 
-  float ydist = 0.0; 
-  float r = 0.0; 
   
-  outFile = fopen(file.c_str(), "w");
+  outFile = outputOpen(file);
+  if(outFile == NULL)
+    {
+      std::cerr << "Cannot open file for write" << std::endl; 
+      return; 
+    }
 
 
   fprintf(outFile, "Graphics[{Black");
@@ -180,10 +217,7 @@ void MakeHoney(Graph& bilayer, string nfile="bilayer", float rmax =10.0)
     {
       for(unsigned int i =0; i < bilayer.vertices[j]->edges.size(); i++)
         {
-	  xdist = bilayer.vertices[j]->x - bilayer.vertices[j]->edges[i]->x; 
-	  ydist = bilayer.vertices[j]->y - bilayer.vertices[j]->edges[i]->y; 
-	  r = sqrt(xdist*xdist + ydist*ydist); 
-	  if(r < rmax )
+	  if(!bilayer.vertices[j]->images[i].wraps())
 	    {
 
 	      fprintf(outFile, ", \nLine[{{%f,%f},{%f,%f}}]", bilayer.vertices[j]->x,
@@ -197,136 +231,175 @@ void MakeHoney(Graph& bilayer, string nfile="bilayer", float rmax =10.0)
 
   fprintf(outFile, "\n}]");
   fprintf(outFile,"\nExport[\"%s\",%%]",(nfile+extpdf).c_str()); 
-  fclose(outFile);
+  outputClose(outFile);
 }
 
 
 
-void fillCountBucket(int countBucket[], std::vector <std::vector<Vertex*> > &allCycles,string nfile="bilayer")
+/*
+  fillCountBucket, counts the rings of each size 
+  @param countBucket, ring counts indexed by ring size, sized for the largest ring
+  @param allCycles, ring list 
+*/
+void fillCountBucket(std::vector<int> &countBucket, std::vector <std::vector<Vertex*> > &allCycles)
 {
-
-  string extdat ="_ringCount.dat"; 
-  string file = nfile + extdat; 
+  int ringmax = countBucket.size(); 
   
-  std::vector <int> list;
   for(int i =0; i<ringmax; i++) countBucket[i] =0;
   for(unsigned int i =0; i<allCycles.size(); i++) countBucket[allCycles[i].size()]++;
-  for(int i =0; i<ringmax; i++) list.push_back(countBucket[i]);
-  
-  stack.push_back(list);
-  list.clear();
-  
+}//fillCountBucket()
+
+/*
+  ringCountOut, writes the ring counts to basename_ringCount.dat 
+  @param countBucket, ring counts indexed by ring size 
+  @param nfile, basename of the output file
+*/
+void ringCountOut(std::vector<int> &countBucket, string nfile="bilayer")
+{
+
+  string extdat ="_ringCount.dat"; 
+  string file = nfile + extdat; 
+  int ringmax = countBucket.size(); 
 
   int ring_sum =0;
   for(int i =0; i < ringmax; i++) { ring_sum += i*countBucket[i];}
   int sum =0;
   for(int i = 0; i < ringmax; i++){sum += countBucket[i];}
 
-  double average = (double) ring_sum/sum;
+  double average = sum ? (double) ring_sum/sum : 0.;
 
   FILE* count;
   
-  count = fopen(file.c_str(), "w");
+  count = outputOpen(file);
+  if(count == NULL)
+    {
+      std::cerr << "Cannot open file for write" << std::endl; 
+      return; 
+    }
   fprintf(count, "Ring Statistics\n");
   for(int i =0; i < ringmax; i++) fprintf(count, "%d RINGS: %d\n", i, countBucket[i]);
   fprintf(count, "RING SUM: %d\n",ring_sum);
   fprintf(count, "SUM: %d\n", sum);
   fprintf(count, "AVERAGE: %f\n",average);
   fprintf(count, "\n");
-  fclose(count);
+  outputClose(count);
 
-}//fillCountBucket()
+}//ringCountOut()
+
+/*
+  ringsBySize, the rings of each size up to ringmax, in their order in
+  the ring list, found in a single pass 
+  @param allCycles, the ring list 
+  @param ringmax, largest ring size kept 
+  @param bySize, indices in the ring list of the rings of each size 
+*/
+void ringsBySize(std::vector <std::vector<Vertex*> > &allCycles, unsigned int ringmax, std::vector<std::vector<int> > &bySize)
+{
+  bySize.assign(ringmax+1,std::vector<int>()); 
+  for(unsigned int j = 0; j < allCycles.size(); j++)
+    if(allCycles[j].size() <= ringmax)
+      bySize[allCycles[j].size()].push_back(j); 
+}//ringsBySize()
 
 /*
   cycleDump,Outputs Rings in Mathematica format
   @param allCycles, vector of vector of Vertex objects containing rings
+  @param ringmax, largest ring size 
+  @param nfile, basename of the output file
 */
-void cycleDump(std::vector <std::vector<Vertex*> > &allCycles)
+void cycleDump(std::vector <std::vector<Vertex*> > &allCycles, unsigned int ringmax, string nfile="bilayer")
 {
   FILE* cycle;
-  cycle = fopen("cycleList.dat" ,"w");
+  cycle = outputOpen(nfile+"_cycleList.dat");
+  if(cycle == NULL)
+    return; 
+  std::vector<std::vector<int> > bySize; 
+  ringsBySize(allCycles,ringmax,bySize); 
   
-  for(unsigned int i = 0; i<12; i++)
+  OutBuffer buf(cycle); 
+  for(unsigned int i = 0; i<=ringmax; i++)
     {
-      fprintf(cycle,"\n");
-      fprintf(cycle, "RING SIZE %d\n" , i);
-      for(unsigned int j =0; j < allCycles.size(); j++)
+      buf.put("\nRING SIZE "); 
+      buf.putInt(i); 
+      buf.put('\n'); 
+      for(unsigned int j =0; j < bySize[i].size(); j++)
         {
-	  std::vector <Vertex*> Ring = allCycles[j];
-          if(Ring.size() != i) continue;
+	  std::vector <Vertex*> &Ring = allCycles[bySize[i][j]];
           for(unsigned int k =0; k<Ring.size(); k++) 
-	    fprintf(cycle, "Circle[{%f,%f},0.2],\n",Ring[k]->x,Ring[k]->y);
-          fprintf(cycle,"\n");
+	    {
+	      buf.put("Circle[{"); 
+	      buf.putFloat(Ring[k]->x); 
+	      buf.put(','); 
+	      buf.putFloat(Ring[k]->y); 
+	      buf.put("},0.2],\n"); 
+	    }
+	  buf.put('\n');
         }
-      fprintf(cycle, "\n");
+      buf.put('\n');
     }
+  buf.flush(); 
   
-  fclose(cycle);
+  outputClose(cycle);
 }//cycleDump()
 
-void polygonGraphics(std::vector <std::vector<Vertex*> > &allCycles, string nfile="bilayer")
+/*
+  polygonGraphics, Outputs the rings as polygons colored by size in Mathematica format 
+  @param allCycles, sorted rings 
+  @param minRing, smallest ring size drawn 
+  @param maxRing, largest ring size drawn 
+  @param nfile, basename of the output file
+*/
+void polygonGraphics(std::vector <std::vector<Vertex*> > &allCycles, unsigned int minRing, unsigned int maxRing, string nfile="bilayer")
 {
   string ext ="_poly.m";
   string extpdf="_poly.pdf"; 
   string file = nfile+ext; 
    
-
-  unsigned int minRing = 4; //4 
-  unsigned int maxRing = 10; //10
-
-  const char *colors[11]; //11
-  colors[4]="Blue"; //4
-  colors[5]="Black"; //5
-  colors[6]="Yellow"; //6
-  colors[7]="Green"; //7
-  colors[8]="Red"; //8
-  colors[9]="Purple"; //9
-  colors[10]="Cyan"; //10
+  //colors start at 4 rings and repeat past the end of the list 
+  const char *colors[] = {"Blue","Black","Yellow","Green","Red","Purple","Cyan",
+			  "Orange","Pink","Brown","Gray","Magenta","LightBlue","LightGreen"}; 
+  const int ncolors = sizeof(colors)/sizeof(colors[0]); 
 
   FILE* poly; 
-  poly = fopen(file.c_str(), "w"); 
-  fprintf(poly, "Graphics[{\n"); 
-  fprintf(poly, "EdgeForm[Thick]\n"); 
-  bool first;
-
-  while( minRing <= maxRing )
+  poly = outputOpen(file); 
+  if(poly == NULL)
+    return; 
+  std::vector<std::vector<int> > bySize; 
+  ringsBySize(allCycles,maxRing,bySize); 
+
+  OutBuffer buf(poly); 
+  buf.put("Graphics[{\nEdgeForm[Thick]\n"); 
+  for(; minRing <= maxRing; minRing++)
     {
-      first=true;
-      fprintf(poly,","); 
-      fprintf(poly,"%s",colors[minRing]); 
-      fprintf(poly,",\n"); 
-      
-      fprintf(poly, "Polygon[{\n"); 
-      for(unsigned int i = 0; i < allCycles.size(); i++)
+      buf.put(','); 
+      buf.put(colors[(((int)minRing-4)%ncolors+ncolors)%ncolors]); 
+      buf.put(",\nPolygon[{\n"); 
+      for(unsigned int i = 0; i < bySize[minRing].size(); i++)
 	{
-	  if ( allCycles[i].size() != minRing ) continue; 
-
-	  if (first)
-	    {
-	      fprintf(poly," ");
-	      first=false;
-	    }
-	  else
-	    {
-	      fprintf(poly,","); 
-	    }
-	  fprintf(poly,"{ "); 
-	  for(unsigned int j = 0; j < allCycles[i].size(); j++)
+	  std::vector<Vertex*> &ring = allCycles[bySize[minRing][i]]; 
+	  buf.put(i == 0 ? " { " : ",{ "); 
+	  for(unsigned int j = 0; j < ring.size(); j++)
 	    {
 	      if ( j != 0)
-		fprintf(poly,","); 
-	      fprintf(poly, "{%f,%f}",allCycles[i][j]->x, allCycles[i][j]->y); 
+		buf.put(','); 
+	      buf.put('{'); 
+	      buf.putFloat(ring[j]->x); 
+	      buf.put(','); 
+	      buf.putFloat(ring[j]->y); 
+	      buf.put('}'); 
 	    }//j loop over vertices in cycle
-	  fprintf(poly, "}\n"); 
+	  buf.put("}\n"); 
 	}//i loop over cycle
-      fprintf(poly, "}]\n");//closes up Polygon
-      minRing += 1; //1 
+      buf.put("}]\n");//closes up Polygon
     }//for color of rings 
 
-  fprintf(poly, "}]\n");//closes of Graphics
-  fprintf(poly, "Export[\"%s\",%%]",(nfile+extpdf).c_str()); 
+  buf.put("}]\n");//closes of Graphics
+  buf.put("Export[\""); 
+  buf.put((nfile+extpdf).c_str()); 
+  buf.put("\",%]"); 
+  buf.flush(); 
 
-  fclose(poly); 
+  outputClose(poly); 
 }//PolygonGraphics()
 
 
@@ -348,64 +421,65 @@ void AddRings(vector <vector<Vertex*> > &allCycles)
   RemoveRings to vertices. Good for removing the wrong rings
   after a sort and adding the right ones. 
  */
-void RemoveRings(Graph &bilayer)
+void RemoveRings(std::vector<Vertex*> &vertices)
 {
-  for(unsigned int i = 0; i < bilayer.vertices.size(); i++)
+  for(unsigned int i = 0; i < vertices.size(); i++)
     {
-      bilayer.vertices[i]->rings.clear(); 
+      vertices[i]->rings.clear(); 
     }
 }
 
 /*
   secondSort,Deletes rings that are combination of others from the ring list.
-  @param bilayer, bilayer object
+  @param vertices, vertices of the sample or of a layer
   @param allCycles, vector of vector of Vertex* containing ring list 
   @param i, int of the vertex
 */
-void secondSort(Graph &bilayer, std::vector<std::vector<Vertex*> > &allCycles, int i)
+void secondSort(std::vector<Vertex*> &vertices, std::vector<std::vector<Vertex*> > &allCycles, int i)
 {
-  for(unsigned int k = 0; k < bilayer.vertices[i]->rings.size(); k++) //iterate through ring list of vertex i to find a ring greater than seven  
+  long removed = 0; 
+  for(unsigned int k = 0; k < vertices[i]->rings.size(); k++) //iterate through ring list of vertex i to find a ring greater than seven  
     {
-      if(bilayer.vertices[i]->rings[k].size() < 7) //7
+      if(vertices[i]->rings[k].size() < 7) //7
 	continue; 
-      std::vector <Vertex*> kCycle = bilayer.vertices[i]->rings[k]; 
-      for(unsigned int l = 0; l< bilayer.vertices[i]->rings.size(); l++)//iterate through all rings of the vertex to find smaller rings that are apart of the greater 
+      std::vector <Vertex*> kCycle = vertices[i]->rings[k]; 
+      for(unsigned int l = 0; l< vertices[i]->rings.size(); l++)//iterate through all rings of the vertex to find smaller rings that are apart of the greater 
 	{
-	  if(bilayer.vertices[i]->rings[l].size() >= kCycle.size() )
+	  if(vertices[i]->rings[l].size() >= kCycle.size() )
 	    continue; 
-	  std::vector <Vertex*> lCycle = bilayer.vertices[i]->rings[l]; 
-	  int num_matches = 0; 
-	  for(unsigned int m = 0; m < lCycle.size(); m++)//iterate through the vertices of the smaller ring to see if they are in the larger ring
-	    {
-	      for(unsigned int n = 0; n < kCycle.size(); n++)
-		{
-		  if(lCycle[m] == kCycle[n])
-		    num_matches++; 
-		}//n loop over the vertices of the kCycle 
-	    }//m loop over the vertices of lCycle 
+	  std::vector <Vertex*> &lCycle = vertices[i]->rings[l]; 
+	  int num_matches = ringSharedVertices(lCycle, kCycle); //vertices of the smaller ring that are in the larger ring
 	  if(num_matches > 3) //3
 	    {
 	      for(unsigned int o = 0; o < allCycles.size(); o++)
 		{
 		  if(kCycle == allCycles[o])
-		    allCycles.erase(allCycles.begin() + o); 
+		    {
+		      allCycles.erase(allCycles.begin() + o); 
+		      removed++; 
+		    }
 		}//i loop over the CycleList 
 	    }
 	}// l loop over the ring list 
     }//k loop over the rings looking for rings greater than nine specific vertex 
+  profileCount(PROF_SECONDSORT_REMOVED,removed); 
 }//secondSort()
 
 /*
   Caclulates second moment from ring distribution. 
+  @param countBucket, ring counts indexed by ring size
  */
-float secondmoment()
+float secondmoment(std::vector<int> &countBucket)
 {
+  int ringmax = countBucket.size(); 
   int sum = 0;  
   float avgringsize = 0.0;  
   float moment2 = 0.0; 
 
   for(int i = 0; i < ringmax; i++)
     sum += countBucket[i];
+  if(sum == 0)
+    return 0.0; 
       
   for(int i = 0; i< ringmax; i++)
     avgringsize += i*((float)countBucket[i]/sum); 
@@ -417,67 +491,220 @@ float secondmoment()
 
 }//secondmoment()
 
-void ringstatsOut(int countBucket[], string nfile ="bilayer")
+void ringstatsOut(std::vector<int> &countBucket, int ringmin, string nfile ="bilayer")
 {
+  int ringmax = countBucket.size(); 
   string ext = "_ringhist.dat"; 
   string file = nfile+ext; 
     
   FILE *out; 
 
-  out = fopen(file.c_str(),"w"); 
+  out = outputOpen(file); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write" << std::endl; 
+      return; 
+    }
 
-  fprintf(out,"%f\n",secondmoment()); 
-  for(int i = 4; i < ringmax; i++)
+  fprintf(out,"%f\n",secondmoment(countBucket)); 
+  for(int i = ringmin; i < ringmax; i++)
     fprintf(out,"%d %d\n",i,countBucket[i]); 
 
-  fclose(out); 
+  outputClose(out); 
 }//ringstatsOut()
 
-void areastatsOut(float areaBucket[], float areabndlength, string nfile="bilayer")
+void areastatsOut(std::vector<float> &areaBucket, float areabndlength, int ringmin, string nfile="bilayer")
 {
+  int ringmax = areaBucket.size(); 
 
   string ext ="_areahist.dat";
   string file = nfile+ext; 
   FILE *out; 
   
-  out = fopen(file.c_str(),"w");
+  out = outputOpen(file);
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write" << std::endl; 
+      return; 
+    }
   fprintf(out,"%f\n",areabndlength);
-  for(int i = 4; i < ringmax; i++)
+  for(int i = ringmin; i < ringmax; i++)
     fprintf(out,"%d %f\n",i,areaBucket[i]); 
 
-  fclose(out); 
+  outputClose(out); 
   
 }//areastatsOut()
 
-void readParameters(char *nfile,float &bondlength, string &basename, float &a, float &b)
+/*
+  paramText, text of a parameter element 
+  @param root, root element of the parameter file
+  @param name, name of the parameter
+  @return text of the element or NULL if it is missing 
+*/
+const char* paramText(tinyxml2::XMLElement *root, const char *name)
+{
+  tinyxml2::XMLElement *element = root->FirstChildElement(name); 
+  if(element == NULL)
+    return NULL; 
+  return element->GetText(); 
+}//paramText()
+
+/*
+  readParameters, reads the xml parameter file. Older parameter files
+  without distbond or pbc bond by distance without PBC. 
+  @param nfile, xml file
+  @param par, parameters to fill 
+  @return 0 on success, -1 if the file or a required parameter is missing
+*/
+int readParameters(const char *nfile, Parameters &par)
 {
   tinyxml2::XMLDocument doc; 
-  doc.LoadFile(nfile); 
-
-  bool distbond = atoi( doc.FirstChildElement("root")->FirstChildElement("distbond")->GetText() ); 
-  if(distbond)
-    bondlength = atof( doc.FirstChildElement("root")->FirstChildElement("bondlength")->GetText() );
+  if(doc.LoadFile(nfile) != tinyxml2::XML_NO_ERROR || doc.FirstChildElement("root") == NULL)
+    {
+      std::cerr << "Cannot read parameter file: " << nfile << std::endl; 
+      return -1; 
+    }
+  tinyxml2::XMLElement *root = doc.FirstChildElement("root"); 
+
+  const char *text = paramText(root,"bondlength"); 
+  bool distbond = (text != NULL); 
+  if(paramText(root,"distbond"))
+    distbond = atoi( paramText(root,"distbond") ); 
+  //bondlength auto picks the cutoff from the pair distances 
+  par.autobond = distbond && text && string(text) == "auto"; 
+  if(distbond && text && !par.autobond)
+    par.bondlength = atof(text);
   else
-    bondlength = 0; 
+    par.bondlength = 0; 
+  par.pdfrange = 5.0; 
+  if(paramText(root,"pdfrange"))
+    par.pdfrange = atof(paramText(root,"pdfrange")); 
+  if(par.autobond && par.pdfrange <= 0)
+    {
+      std::cerr << "pdfrange must be positive in: " << nfile << std::endl; 
+      return -1; 
+    }
 
-  basename = doc.FirstChildElement("root")->FirstChildElement("basename")->GetText(); 
-  bool pbc = atoi( doc.FirstChildElement("root")->FirstChildElement("pbc")->GetText() );
+  if(paramText(root,"basename") == NULL)
+    {
+      std::cerr << "No basename in parameter file: " << nfile << std::endl; 
+      return -1; 
+    }
+  par.basename = paramText(root,"basename"); 
+
+  //bondmode knn bonds nearest neighbors, distance bonds by bondlength 
+  par.knnbond = false; 
+  if(paramText(root,"bondmode"))
+    {
+      string mode = paramText(root,"bondmode"); 
+      if(mode != "knn" && mode != "distance")
+	{
+	  std::cerr << "bondmode must be knn or distance in: " << nfile << std::endl; 
+	  return -1; 
+	}
+      par.knnbond = (mode == "knn"); 
+    }
+  par.bondneighbors = 3; 
+  if(paramText(root,"bondneighbors"))
+    par.bondneighbors = atoi(paramText(root,"bondneighbors")); 
+  par.bondangle = 60; 
+  if(paramText(root,"bondangle"))
+    par.bondangle = atof(paramText(root,"bondangle")); 
+  if(par.knnbond && par.bondneighbors < 1)
+    {
+      std::cerr << "bondneighbors must be at least 1 in: " << nfile << std::endl; 
+      return -1; 
+    }
+  bool pbc = paramText(root,"pbc") && atoi( paramText(root,"pbc") );
 
+  par.cell = Cell(); 
   if(pbc)
     {
-      std::cout << "Using PBC conditions " << std::endl; 
-      a = atof(doc.FirstChildElement("root")->FirstChildElement("latticex")->GetText()); 
-      b = atof(doc.FirstChildElement("root")->FirstChildElement("latticey")->GetText());
-      std::cout << "a: " << a << " " << "b: " << b << std::endl; 
+      float m[9]; 
+      const char *cell = paramText(root,"cell"); 
+      int nread = cell ? sscanf(cell,"%f %f %f %f %f %f %f %f %f",m,m+1,m+2,m+3,m+4,m+5,m+6,m+7,m+8) : 0; 
+      if(nread == 4)
+	par.cell = Cell(m[0],m[1],m[2],m[3]); 
+      else if(nread == 9)
+	par.cell = Cell(m[0],m[1],m[2],m[3],m[4],m[5],m[6],m[7],m[8]); 
+      else if(cell == NULL && paramText(root,"latticex") && paramText(root,"latticey"))
+	par.cell = Cell(atof(paramText(root,"latticex")),0,0,atof(paramText(root,"latticey"))); 
+      if(!par.cell.periodic())
+	{
+	  std::cerr << "PBC requires latticex and latticey or a cell of 4 or 9 numbers in: " << nfile << std::endl; 
+	  return -1; 
+	}
+      LOG(LOG_DEBUG) << "Using PBC conditions " << std::endl; 
+      LOG(LOG_DEBUG) << "a: " << par.cell.ax << " " << par.cell.ay << " " << par.cell.az << " " 
+		<< "b: " << par.cell.bx << " " << par.cell.by << " " << par.cell.bz << std::endl; 
+      if(par.cell.periodicz())
+	LOG(LOG_DEBUG) << "c: " << par.cell.cx << " " << par.cell.cy << " " << par.cell.cz << std::endl; 
     }
-  else
+
+  par.bonddump = paramText(root,"bonddump") && atoi(paramText(root,"bonddump")); 
+  par.npy = paramText(root,"npy") && atoi(paramText(root,"npy")); 
+  par.layers = paramText(root,"layers") && atoi(paramText(root,"layers")); 
+  par.contract = paramText(root,"contract") && atoi(paramText(root,"contract")); 
+  par.cache = paramText(root,"cache") && atoi(paramText(root,"cache")); 
+  if(paramText(root,"cachedir"))
+    par.cachedir = paramText(root,"cachedir"); 
+  par.edits.clear(); 
+  if(paramText(root,"edits") && parseEdits(paramText(root,"edits"),par.edits) != 0)
     {
-      a = 0.;
-      b = 0.; 
+      std::cerr << "Bad edits in: " << nfile << std::endl; 
+      return -1; 
+    }
+  if(paramText(root,"editsfile") && readEdits(paramText(root,"editsfile"),par.edits) != 0)
+    return -1; 
+  par.render = paramText(root,"render") ? atoi(paramText(root,"render")) : 0; 
+  par.rendertiles = 1; 
+  if(paramText(root,"rendertiles"))
+    par.rendertiles = atoi(paramText(root,"rendertiles")); 
+  if(par.render < 0 || par.rendertiles < 1)
+    {
+      std::cerr << "render needs a width of 0 or more pixels and rendertiles at least 1 in: " << nfile << std::endl; 
+      return -1; 
+    }
+  par.bridgecutoff = 1.25; 
+  if(paramText(root,"bridgecutoff"))
+    par.bridgecutoff = atof(paramText(root,"bridgecutoff")); 
+  par.bootstrap = 1000; 
+  if(paramText(root,"bootstrap"))
+    par.bootstrap = atoi(paramText(root,"bootstrap")); 
+  par.ringmin = 4; 
+  par.ringmax = 11; 
+  if(paramText(root,"ringmin"))
+    par.ringmin = atoi(paramText(root,"ringmin")); 
+  if(paramText(root,"ringmax"))
+    par.ringmax = atoi(paramText(root,"ringmax")); 
+  if(par.ringmin < 3 || par.ringmax < par.ringmin)
+    {
+      std::cerr << "Ring sizes need 3 <= ringmin <= ringmax, got " << par.ringmin << " " << par.ringmax << std::endl; 
+      return -1; 
     }
 
-  std::cout << "bondlength: " << bondlength << std::endl; 
-  std::cout << "basename: " << basename << std::endl; 
+  //only the stages of the requested outputs run 
+  par.outputs = DEFAULT_OUTPUTS; 
+  if(paramText(root,"outputs") && parseOutputs(paramText(root,"outputs"),par.outputs) != 0)
+    {
+      std::cerr << "Unknown outputs in: " << nfile << std::endl; 
+      return -1; 
+    }
+  unsigned int stages = outputStages(par.outputs); 
+  if(par.npy)
+    stages |= (1u << STAGE_GEOMETRY) | (1u << STAGE_BONDS) | (1u << STAGE_ABOAV); 
+  if(par.bonddump)
+    stages |= 1u << STAGE_BONDS; 
+  if(par.render > 0)
+    stages |= 1u << STAGE_GEOMETRY; 
+  if(par.cache || !par.cachedir.empty())
+    stages |= 1u << STAGE_RINGS; 
+  par.stages = stageClosure(stages); 
+
+  LOG(LOG_DEBUG) << "bondlength: " << par.bondlength << std::endl; 
+  LOG(LOG_DEBUG) << "basename: " << par.basename << std::endl; 
+  LOG(LOG_DEBUG) << "ring sizes: " << par.ringmin << " to " << par.ringmax << std::endl; 
+  return 0; 
   
 }//readParameters()
 
@@ -492,7 +719,12 @@ void outputRings(string nfile, std::vector <vector<Vertex*> > &allCycles)
   string ext ="_ringlist.dat";
   string file = nfile+ext; 
   FILE *out; 
-  out = fopen(file.c_str(),"w");
+  out = outputOpen(file);
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write" << std::endl; 
+      return; 
+    }
   
   for(unsigned int i = 0; i < allCycles.size(); i++)
     {
@@ -500,117 +732,699 @@ void outputRings(string nfile, std::vector <vector<Vertex*> > &allCycles)
 	fprintf(out,"%d ",allCycles[i][j]->index); 
       fprintf(out,"\n"); 
     }
-  fclose(out); 
+  outputClose(out); 
 
 }//outputRings()
 
-//ringstatsOut
-int main(int argc, char *argv[])
+/*
+  graphMemory, notes the bytes of the vertices and edges of a graph for
+  the memory report 
+  @param bilayer, the graph 
+*/
+void graphMemory(Graph &bilayer)
 {
-  
-  if ( argc < 3 )
+  size_t vertices = vectorBytes(bilayer.vertices) + vectorBytes(bilayer.bridges) 
+    + (bilayer.vertices.size() + bilayer.bridges.size())*sizeof(Vertex); 
+  size_t edges = 0; 
+  for(unsigned int i = 0; i < bilayer.vertices.size(); i++)
     {
-      std::cerr << "Not enough input arguments: " << argc << std::endl; 
-      std::cout << "./main.e coordinates.xyz coordinates.xml coordinates.con" << std::endl; 
-      exit(1);  
+      Vertex *v = bilayer.vertices[i]; 
+      edges += vectorBytes(v->edges) + vectorBytes(v->images) + vectorBytes(v->bridges); 
     }
-  
-  float bondlength; 
-  string basename; 
+  memoryNote(MEM_VERTICES,vertices); 
+  memoryNote(MEM_EDGES,edges); 
+}//graphMemory()
+
+/*
+  incidenceMemory, notes the bytes of the rings kept by each vertex 
+  @param vertices, vertices of the sample or of a layer 
+*/
+void incidenceMemory(std::vector<Vertex*> &vertices)
+{
+  size_t bytes = 0; 
+  for(unsigned int i = 0; i < vertices.size(); i++)
+    bytes += nestedBytes(vertices[i]->rings); 
+  memoryNote(MEM_INCIDENCE,bytes); 
+}//incidenceMemory()
+
+/*
+  geometryMemory, notes the bytes of the ring coordinates and shapes 
+  @param coords, unwrapped ring coordinates 
+  @param geometry, ring shapes 
+*/
+void geometryMemory(RingCoords &coords, RingGeometry &geometry)
+{
+  size_t bytes = vectorBytes(coords.count) + vectorBytes(coords.stride) + vectorBytes(coords.offset) 
+    + vectorBytes(coords.start) + vectorBytes(coords.ring) + vectorBytes(coords.x) + vectorBytes(coords.y) 
+    + vectorBytes(coords.z) + vectorBytes(coords.ox) + vectorBytes(coords.oy) + vectorBytes(coords.oz) 
+    + vectorBytes(coords.wraps); 
+  bytes += vectorBytes(geometry.area) + vectorBytes(geometry.perimeter) + vectorBytes(geometry.cx) 
+    + vectorBytes(geometry.cy) + vectorBytes(geometry.cz) + vectorBytes(geometry.gyration) 
+    + vectorBytes(geometry.anisotropy) + vectorBytes(geometry.convexity) + vectorBytes(geometry.area3d); 
+  memoryNote(MEM_GEOMETRY,bytes); 
+}//geometryMemory()
+
+/*
+  ringStatistics, finds the rings of a set of vertices and writes their
+  statistics. Only the stages that the requested outputs need are run,
+  the statistics of the summary from skipped stages stay 0. Rings only
+  follow edges between vertices of the same layer, so a layer of a
+  bilayer is analyzed with the view of its vertices. The vertices of different calls must not share rings, the
+  layers of a bilayer can then be analyzed concurrently. 
+  @param vertices, vertices of the sample or of a layer 
+  @param par, parameters of the sample 
+  @param nfile, basename of the output files 
+  @param allCycles, rings of the vertices, searched for when empty 
+  @param summary, filled with the statistics 
+  @return 0 
+*/
+int ringStatistics(std::vector<Vertex*> &vertices, Parameters &par, string nfile, std::vector<std::vector<Vertex*> > &allCycles, SampleSummary &summary)
+{
+  std::vector<std::vector<Vertex*> > sortedCycles; 
+  std::vector<int> countBucket;
+  std::vector<double> aboavBucket; 
+  std::vector<std::vector<double> > aboavStack; 
+  std::vector<float> areaBucket; 
   float areasum = 0.; 
-  float bndlength;
+  float bndlength = 0.;
   float bndlength2; 
-  float deviation; 
-  float latticex, latticey; 
-  int depth = ringmax - 1; 
-  //string out = "honeycomb1.m";
+  float deviation = 0.; 
+  BondStats bonds; 
+  RingCoords coords; 
+  RingGeometry geometry; 
+  RingFits fits; 
+  unsigned int out = par.outputs; 
+
+  summary.basename = nfile; 
+  summary.natoms = vertices.size(); 
+  summary.status = 0; 
+  int depth = par.ringmax + 1; 
+
+  //start counting cycles, unless they came from a graph cache 
+  if(hasStage(par.stages,STAGE_RINGS))
+    {
+      if(allCycles.empty())
+	{
+	  LOG(LOG_DEBUG) << "Counting Rings" << std::endl; 
+	  ProfileTimer search(PROF_RINGS); 
+	  for(unsigned int i = 0; i < vertices.size(); i++)
+	    vertices[i]->CountCyclesLocally(depth,allCycles); 
+  
+	  AddRings(allCycles);
+	  search.stop(); 
+	  if(memoryEnabled)
+	    incidenceMemory(vertices); 
+	  LOG(LOG_DEBUG) << "Sorting through the Rings Now" << std::endl; 
+	  ProfileTimer sort(PROF_SECONDSORT); 
+	  for(unsigned int i = 0; i < vertices.size(); i++)
+	    secondSort(vertices,allCycles,i); 
+	}
 
-  //Debug 
-  std::cout << "Number of input arguments is: " << argc << std::endl; 
-  for(int i = 0; i < argc; i++)
-    std::cout << "argv[" << i << "]: " << argv[i] << std::endl; 
- 
+      //Ring Statistics 
+      countBucket.resize(par.ringmax+1); 
+      fillCountBucket(countBucket,allCycles); 
+      if(hasOutput(out,OUT_RINGCOUNT))
+	ringCountOut(countBucket,nfile); 
+      if(hasOutput(out,OUT_CYCLELIST))
+	cycleDump(allCycles,par.ringmax,nfile); 
+      LOG(LOG_INFO) << allCycles.size() << " rings, mu2 = " << secondmoment(countBucket) << std::endl; 
+      if(hasOutput(out,OUT_RINGHIST))
+	ringstatsOut(countBucket,par.ringmin,nfile); 
+
+      int ring_sum = 0; 
+      for(unsigned int i = 0; i < countBucket.size(); i++)
+	ring_sum += i*countBucket[i]; 
+      summary.nrings = allCycles.size(); 
+      summary.average = allCycles.empty() ? 0. : (double)ring_sum/allCycles.size(); 
+      summary.mu2 = secondmoment(countBucket); 
+    }
 
-  read_xyz(argv[1],bilayer);
-  readParameters(argv[2],bondlength,basename,latticex,latticey); 
-  
-  if(bondlength > 0)
+  if(hasStage(par.stages,STAGE_SORT))
     {
-      std::cout << "Making Connections Based On Distance" << std::endl; 
-      connectAtoms(bilayer,bondlength);
+      ProfileTimer timer(PROF_SORT); 
+      for(unsigned int i = 0; i < allCycles.size(); i++)
+	sortedCycles.push_back(ringSort(allCycles[i]));
+      if(memoryEnabled)
+	memoryNote(MEM_RINGS,nestedBytes(allCycles) + nestedBytes(sortedCycles)); 
     }
-  if(argc == 4)
+
+  //Ring Geometry, all rings at once 
+  if(hasStage(par.stages,STAGE_GEOMETRY))
     {
-      std::cout << "Making manual connections" << std::endl; 
-      read_connect(argv[3],bilayer); 
-      MakeHoney(bilayer,basename); 
+      areaBucket.assign(par.ringmax+1,0.0); 
+      ProfileTimer timer(PROF_GEOMETRY); 
+      fillRingCoords(sortedCycles,par.cell,coords); 
+      ringGeometry(coords,geometry); 
+      timer.stop(); 
+      if(memoryEnabled)
+	geometryMemory(coords,geometry); 
+      if(hasOutput(out,OUT_RINGGEOM))
+	ringGeometryOut(sortedCycles,coords,geometry,nfile); 
+
+      FILE *ring = NULL;
+      if(hasOutput(out,OUT_RINGDIST))
+	ring = outputOpen(nfile+"_ringdist.dat"); 
+      for(unsigned int i = 0; i < sortedCycles.size(); i++)
+	{
+	  if(ring)
+	    fprintf(ring,"%d %f\n",(int)sortedCycles[i].size(),geometry.area[i]); 
+	  if(!coords.wraps[i])
+	    areaBucket[sortedCycles[i].size()] += geometry.area[i]; 
+	}
+      if(ring)
+	outputClose(ring); 
+      if(par.npy)
+	ringNpy(sortedCycles,geometry,nfile); 
+      if(par.render > 0)
+	renderRings(coords,par.cell,par.ringmin,par.ringmax,par.render,par.rendertiles,0,nfile); 
+      for(unsigned int i = 0; i < areaBucket.size(); i++)
+	areasum += areaBucket[i]; 
+      LOG(LOG_DEBUG) << "sum of area bucket " << areasum << std::endl; 
     }
-  
-  //Remove Ring 
-  std::cout << "x: " << bilayer.vertices[971]->x << "y: " << bilayer.vertices[971]->y << std::endl; 
-  std::cout << "Before:Number of connections to 971: " << bilayer.vertices[971]->edges.size() << std::endl; 
-  bilayer.vertices[971]->RemoveEdge(bilayer.vertices[152]); 
-  std::cout << "After:Number of connections to 971: " << bilayer.vertices[971]->edges.size() << std::endl; 
- 
- //start counting cycles 
-  std::cout << "Counting Rings" << std::endl; 
-  for(unsigned int i = 0; i < bilayer.vertices.size(); i++)
-    bilayer.vertices[i]->CountCyclesLocally(depth,allCycles); 
-  
-  AddRings(allCycles);
-  std::cout << "Sorting through the Rings Now" << std::endl; 
-  for(unsigned int i = 0; i < bilayer.vertices.size(); i++)
-    secondSort(bilayer,allCycles,i); 
 
-  //Ring Statistics 
-  fillCountBucket(countBucket,allCycles,basename); 
-  cycleDump(allCycles); 
-  std::cout << "mu2 = " << secondmoment() << std::endl; 
-    
-  
-   
-  for(int i = 0; i < ringmax; i++) areaBucket[i] = 0.0; 
+  if(hasStage(par.stages,STAGE_FILTER))
+    {
+      PolygonPBC(sortedCycles); 
+      if(hasOutput(out,OUT_POLY))
+	polygonGraphics(sortedCycles,par.ringmin,par.ringmax,nfile); 
+      if(hasOutput(out,OUT_RINGLIST))
+	outputRings(nfile,sortedCycles); 
+      if(par.contract && hasOutput(out,OUT_ORINGLIST))
+	oringsOut(sortedCycles,nfile); 
+    }
 
-  FILE *ring;
-  std::vector<Vertex*> cycle; 
-  string ext = "_ringdist.dat";
-  ring = fopen((basename+ext).c_str(),"w"); 
-  for(unsigned int i = 0; i < allCycles.size(); i++)
-      {
-	cycle = ringSort(allCycles[i]); 
-	fprintf(ring,"%d %f\n",allCycles[i].size(),ringArea(cycle,areaBucket,latticex,latticey) ); 
-	sortedCycles.push_back(ringSort(allCycles[i]));
-      }
-  fclose(ring); 
+  if(hasStage(par.stages,STAGE_BONDS))
+    {
+      ProfileTimer timer(PROF_BONDS); 
+      bondStatistics(vertices,par.cell,bonds); 
+      timer.stop(); 
+      if(hasOutput(out,OUT_BONDHIST))
+	bondhistOut(bonds,nfile); 
+      if(par.bonddump)
+	bondDump(bonds,nfile); 
+      if(par.npy)
+	bondNpy(bonds,nfile); 
+      bndlength = bonds.mean; 
+      deviation = sqrt(bonds.variance()); 
+      bndlength2 = bonds.variance() + bonds.mean*bonds.mean; 
+
+      LOG(LOG_INFO) << "average bond length " << bndlength << std::endl; 
+      LOG(LOG_DEBUG) << "average bond lenth squared" << bndlength2 << std::endl; 
+      LOG(LOG_DEBUG) << "deviation bond length: " << deviation << std::endl; 
+      LOG(LOG_DEBUG) << "bond length range: " << bonds.min << " " << bonds.max << std::endl; 
+      summary.nbonds = bonds.nbonds; 
+      summary.bndlength = bndlength; 
+      summary.deviation = deviation; 
+    }
 
-  
-  PolygonPBC(sortedCycles); 
-  polygonGraphics(sortedCycles,basename); 
-  bndlength = avgbnd_length(bilayer,latticex,latticey); 
-  bndlength2 = avgbnd_lengthtwo(bilayer,latticex,latticey); 
-  deviation = sqrt(bndlength2-bndlength*bndlength); 
+  //areas in units of the bond length, which a sample without bonds has not 
+  if(hasStage(par.stages,STAGE_GEOMETRY) && hasStage(par.stages,STAGE_BONDS) && bndlength > 0)
+    {
+      LOG(LOG_DEBUG) << "area/avgbondlength*2 " << areasum/( bndlength*bndlength ) << std::endl; 
+      for(unsigned int i = 0; i < areaBucket.size(); i++)
+	areaBucket[i] /= bndlength*bndlength;
+      if(hasOutput(out,OUT_AREAHIST))
+	areastatsOut(areaBucket,areasum/(bndlength*bndlength),par.ringmin,nfile); 
+      summary.arealength = areasum/(bndlength*bndlength); 
+    }
+
+  if(hasOutput(out,OUT_CONNECTIVITY))
+    outputConnect(vertices,nfile); 
+
+  //a sample without rings has no Aboav function and nothing to fit 
+  if(allCycles.empty())
+    return 0; 
 
-  for(int i = 0; i < ringmax; i++)
-    areasum += areaBucket[i]; 
-  
-  std::cout << "sum of area bucket " << areasum << std::endl; 
-  std::cout << "average bond length " << avgbnd_length(bilayer,latticex,latticey) << std::endl; 
-  std::cout << "average bond lenth squared" << avgbnd_lengthtwo(bilayer,latticex,latticey) << std::endl; 
-  std::cout << "deviation bond length: " << deviation << std::endl; 
-  std::cout << "area/avgbondlength*2 " << areasum/( bndlength*bndlength ) << std::endl; 
-  
-  for(int i = 0; i < ringmax; i++)
-    areaBucket[i] /= bndlength*bndlength;
-  
-  ringstatsOut(countBucket,basename); 
-  areastatsOut(areaBucket,areasum/(bndlength*bndlength),basename); 
-  outputRings(basename,sortedCycles); 
-  outputConnect(bilayer,latticex,latticey); 
   //Running Aboav function 
-  RemoveRings(bilayer); 
-  AddRings(allCycles);
-  Aboav(allCycles,aboavBucket,aboavStack,ringmax); 
+  if(hasStage(par.stages,STAGE_ABOAV))
+    {
+      aboavBucket.resize(par.ringmax+1); 
+      ProfileTimer timer(PROF_ABOAV); 
+      RemoveRings(vertices); 
+      AddRings(allCycles);
+      Aboav(allCycles,&aboavBucket[0],aboavStack,aboavBucket.size(),out,nfile); 
+      timer.stop(); 
+      if(memoryEnabled)
+	{
+	  incidenceMemory(vertices); 
+	  memoryNote(MEM_ABOAV,nestedBytes(aboavStack)); 
+	}
+      if(par.npy)
+	aboavNpy(aboavStack,nfile); 
+    }
+
+  if(hasStage(par.stages,STAGE_FITS))
+    {
+      ProfileTimer timer(PROF_FITS); 
+      ringFits(coords,geometry,aboavStack,bndlength,par.bootstrap,fits); 
+      timer.stop(); 
+      if(hasOutput(out,OUT_FITS))
+	fitsOut(fits,nfile); 
+      summary.lewis = fits.lewis.slope; 
+      summary.alpha = fits.aboav.fitted ? 6 - fits.aboav.slope : 0.; 
+    }
+  return 0; 
+}//ringStatistics()
+
+/*
+  Layer analyzed by one thread 
+ */
+struct LayerTask
+{
+  LayerView *view; 
+  Parameters *par; 
+  std::vector<std::vector<Vertex*> > rings; 
+  SampleSummary summary; 
+};
+
+/*
+  layerWorker, thread running the ring statistics of one layer 
+ */
+void* layerWorker(void *arg)
+{
+  LayerTask *task = (LayerTask*)arg; 
+  ringStatistics(task->view->vertices,*task->par,task->par->basename + task->view->name,task->rings,task->summary); 
+  return NULL; 
+}//layerWorker()
+
+/*
+  mergeLayerSummaries, statistics of a bilayer from those of its
+  layers. Counts add, the moments of the ring sizes and bond lengths
+  are pooled, the area per bond length squared adds and the fitted
+  slopes are averaged weighted by the number of rings. 
+  @param layers, summary of each layer 
+  @param summary, summary of the sample 
+*/
+void mergeLayerSummaries(std::vector<SampleSummary> &layers, SampleSummary &summary)
+{
+  summary.natoms = summary.nbonds = summary.nrings = 0; 
+  summary.average = summary.bndlength = summary.arealength = 0.; 
+  summary.lewis = summary.alpha = 0.; 
+  summary.status = 0; 
+  for(unsigned int l = 0; l < layers.size(); l++)
+    {
+      if(layers[l].status != 0)
+	{
+	  summary.status = layers[l].status; 
+	  summary.error = layers[l].basename + ": " + layers[l].error; 
+	}
+      summary.natoms += layers[l].natoms; 
+      summary.nbonds += layers[l].nbonds; 
+      summary.nrings += layers[l].nrings; 
+      summary.average += layers[l].nrings*layers[l].average; 
+      summary.bndlength += layers[l].nbonds*layers[l].bndlength; 
+      summary.arealength += layers[l].arealength; 
+      summary.lewis += layers[l].nrings*layers[l].lewis; 
+      summary.alpha += layers[l].nrings*layers[l].alpha; 
+    }
+  if(summary.nrings > 0)
+    {
+      summary.average /= summary.nrings; 
+      summary.lewis /= summary.nrings; 
+      summary.alpha /= summary.nrings; 
+    }
+  if(summary.nbonds > 0)
+    summary.bndlength /= summary.nbonds; 
+
+  double mu2 = 0., var = 0.; 
+  for(unsigned int l = 0; l < layers.size(); l++)
+    {
+      double da = layers[l].average - summary.average; 
+      double db = layers[l].bndlength - summary.bndlength; 
+      mu2 += layers[l].nrings*(layers[l].mu2 + da*da); 
+      var += layers[l].nbonds*(layers[l].deviation*layers[l].deviation + db*db); 
+    }
+  summary.mu2 = summary.nrings > 0 ? mu2/summary.nrings : 0.; 
+  summary.deviation = summary.nbonds > 0 ? sqrt(var/summary.nbonds) : 0.; 
+}//mergeLayerSummaries()
+
+/*
+  siliconOxygenOut, writes the Si-O bonds of a contracted full-atom
+  sample, from its silicons and the oxygens of its bridges 
+  @param bilayer, contracted graph of the sample 
+  @param par, parameters of the sample 
+*/
+void siliconOxygenOut(Graph &bilayer, Parameters &par)
+{
+  std::vector<int> silicon, oxygen; 
+  connectSi2O(bilayer,par.bridgecutoff,par.cell,silicon,oxygen); 
+  siOxygenOut(silicon,oxygen,par.basename); 
+}//siliconOxygenOut()
+
+/*
+  connectSample, bonds the atoms of a sample read from coordinates,
+  applies the edge edits and contracts the Si-O-Si bridges of a
+  full-atom sample 
+  @param bilayer, graph of the sample 
+  @param par, parameters of the sample, the bondlength is set with autobond 
+  @param confile, connectivity file or NULL to bond by distance only 
+  @param leiden, whether the sample was read with its connections 
+  @param summary, error of the sample 
+  @return 0 on success, -1 if the connections could not be read, no
+  bond cutoff is found or an edit is out of range 
+*/
+int connectSample(Graph &bilayer, Parameters &par, const char *confile, bool leiden, SampleSummary &summary)
+{
+  if(par.autobond && !par.knnbond)
+    {
+      ProfileTimer timer(PROF_BOND); 
+      PairDistribution pdf; 
+      pairDistribution(bilayer.vertices,par.cell,par.pdfrange,pdf); 
+      timer.stop(); 
+      if(hasOutput(par.outputs,OUT_PDF))
+	pdfOut(pdf,par.basename); 
+      if(pdf.cutoff <= 0)
+	{
+	  std::cerr << "No minimum after the first peak of the pair distances within " << par.pdfrange << std::endl; 
+	  summary.error = "no bond cutoff found"; 
+	  return -1; 
+	}
+      par.bondlength = pdf.cutoff; 
+      LOG(LOG_INFO) << "Bond cutoff " << pdf.cutoff << " at the first minimum of the pair distances, peak at " << pdf.peak << std::endl; 
+    }
+  if(par.knnbond)
+    {
+      LOG(LOG_DEBUG) << "Making Connections To Nearest Neighbors" << std::endl; 
+      ProfileTimer timer(PROF_BOND); 
+      connectNearest(bilayer,par.bondneighbors,par.bondangle,par.cell); 
+    }
+  else if(par.bondlength > 0)
+    {
+      LOG(LOG_DEBUG) << "Making Connections Based On Distance" << std::endl; 
+      ProfileTimer timer(PROF_BOND); 
+      connectAtoms(bilayer,par.bondlength,par.cell);
+    }
+  if(confile && !leiden)
+    {
+      LOG(LOG_DEBUG) << "Making manual connections" << std::endl; 
+      ProfileTimer timer(PROF_BOND); 
+      if(read_connect(confile,bilayer,par.cell) != 0)
+	{
+	  summary.error = "cannot read connections"; 
+	  return -1; 
+	}
+      timer.stop(); 
+      if(hasOutput(par.outputs,OUT_STRUCTURE))
+	MakeHoney(bilayer,par.basename); 
+    }
+
+  //edge edits of the parameter file, then the edits proposed for the
+  //coordination defects left 
+  if(!par.edits.empty() && applyEdits(bilayer,par.edits,par.cell) != 0)
+    {
+      summary.error = "edge edit out of range"; 
+      return -1; 
+    }
+  if(hasOutput(par.outputs,OUT_EDITS))
+    {
+      std::vector<EdgeEdit> proposed; 
+      int ndefects = proposeEdits(bilayer,par.cell,proposed); 
+      if(ndefects > 0)
+	LOG(LOG_INFO) << ndefects << " coordination defects, " << proposed.size() << " edits proposed in " 
+		      << par.basename << "_edits.dat" << std::endl; 
+      editsOut(proposed,par.basename); 
+    }
+  if(par.contract)
+    {
+      ProfileTimer timer(PROF_CONTRACT); 
+      contractBridges(bilayer,par.bridgecutoff,par.cell); 
+      timer.stop(); 
+      if(hasOutput(par.outputs,OUT_SIO))
+	siliconOxygenOut(bilayer,par); 
+    }
+  return 0; 
+}//connectSample()
+
+/*
+  analyzeSample, runs the ring statistics on a single sample. All of the
+  state of the sample is local so that samples can be analyzed concurrently.
+  A graph cache (.bgc) in place of the coordinates file brings the
+  bonded graph and its rings, only the statistics are computed again.
+  With a cachedir, the graph and rings are looked up by the key of the
+  inputs and stored there after a miss. 
+  @param xyzfile, coordinates file
+  @param xmlfile, parameter file
+  @param confile, connectivity file or NULL to bond by distance only
+  @param summary, filled with the statistics of the sample
+  @return 0 on success, -1 if the sample could not be read 
+*/
+int analyzeSample(const char *xyzfile, const char *xmlfile, const char *confile, SampleSummary &summary)
+{
+  Graph bilayer; 
+  Parameters par; 
+  Cell cell; 
+  std::vector<LayerView> layers; 
+  std::vector<std::vector<Vertex*> > rings; 
+  bool leiden = isLeiden(xyzfile); 
+  bool cached = isGraphCache(xyzfile); 
+
+  summary.status = -1; 
+  if(readParameters(xmlfile,par) != 0)
+    {
+      summary.error = "cannot read parameters"; 
+      return -1; 
+    }
+  summary.basename = par.basename; 
+
+  ProfileTimer read(PROF_READ); 
 
+  //the graph and rings of the same inputs from the content addressed cache 
+  string cachefile; 
+  bool hit = false; 
+  if(!cached && !par.cachedir.empty())
+    {
+      string connect = confile ? string(confile) : leiden ? leidenConnect(xyzfile) : string(); 
+      string key = sampleKey(xyzfile,connect.empty() ? NULL : connect.c_str(),par); 
+      if(!key.empty())
+	cachefile = sampleCacheFile(par.cachedir,key); 
+      if(!cachefile.empty() && access((cachefile + ".bgc").c_str(),R_OK) == 0)
+	{
+	  hit = readGraphCache((cachefile + ".bgc").c_str(),bilayer,cell,rings,summary) == 0; 
+	  if(!hit)
+	    {
+	      bilayer.clear(); 
+	      rings.clear(); 
+	      cell = Cell(); 
+	    }
+	}
+    }
+
+  if(hit)
+    LOG(LOG_INFO) << "Rings from the cache " << cachefile << ".bgc" << std::endl; 
+  else if(cached)
+    {
+      if(readGraphCache(xyzfile,bilayer,cell,rings,summary) != 0)
+	{
+	  summary.error = "cannot read graph cache"; 
+	  return -1; 
+	}
+    }
+  else if(leiden)
+    {
+      string connect = confile ? string(confile) : leidenConnect(xyzfile); 
+      if(read_leiden(xyzfile,connect.c_str(),bilayer,cell) != 0)
+	{
+	  summary.error = "cannot read Leiden network"; 
+	  return -1; 
+	}
+    }
+  else if(read_xyz(xyzfile,bilayer) != 0)
+    {
+      summary.error = "cannot read coordinates"; 
+      return -1; 
+    }
+  summary.natoms = bilayer.vertices.size(); 
+  read.stop(); 
+  if((leiden || cached || hit) && cell.periodic())
+    par.cell = cell; 
+
+  if(cached || hit)
+    {
+      //the rings were searched up to the ringmax of the cached run 
+      for(unsigned int i = 0; i < rings.size(); i++)
+	if((int)rings[i].size() > par.ringmax)
+	  par.ringmax = rings[i].size(); 
+      //the bridges are cached, the Si-O bonds can be found again 
+      if(par.contract && !bilayer.bridges.empty() && hasOutput(par.outputs,OUT_SIO))
+	siliconOxygenOut(bilayer,par); 
+    }
+  else if(connectSample(bilayer,par,confile,leiden,summary) != 0)
+    return -1; 
+  if(memoryEnabled)
+    graphMemory(bilayer); 
+
+  if(!par.layers || classifyLayers(bilayer,layers) == 1)
+    {
+      ringStatistics(bilayer.vertices,par,par.basename,rings,summary); 
+      if(par.cache && !cached && !hit)
+	writeGraphCache(bilayer,par.cell,rings,summary,par.basename); 
+      if(!cachefile.empty() && !hit)
+	writeGraphCache(bilayer,par.cell,rings,summary,cachefile); 
+      return summary.status; 
+    }
+
+  //both layers at once if the thread budget has a helper, each on the
+  //view of its vertices 
+  std::vector<LayerTask> tasks(layers.size()); 
+  std::vector<pthread_t> threads(layers.size()); 
+  int helpers = threadsAcquire(layers.size() - 1); 
+  for(unsigned int l = 0; l < layers.size(); l++)
+    {
+      LOG(LOG_INFO) << "Layer " << l << ": " << layers[l].vertices.size() << " vertices at z = " << layers[l].z << std::endl; 
+      tasks[l].view = &layers[l]; 
+      tasks[l].par = &par; 
+      //rings never cross the layers 
+      for(unsigned int i = 0; i < rings.size(); i++)
+	if(rings[i][0]->layer == layers[l].layer)
+	  tasks[l].rings.push_back(rings[i]); 
+    }
+  for(unsigned int l = 1; l <= (unsigned int)helpers; l++)
+    pthread_create(&threads[l],NULL,layerWorker,&tasks[l]); 
+  for(unsigned int l = helpers + 1; l < layers.size(); l++)
+    layerWorker(&tasks[l]); 
+  layerWorker(&tasks[0]); 
+  for(unsigned int l = 1; l <= (unsigned int)helpers; l++)
+    pthread_join(threads[l],NULL); 
+  threadsRelease(helpers); 
+
+  if(hasOutput(par.outputs,OUT_REGISTRATION))
+    {
+      Registration reg; 
+      layerRegistration(layers[1],layers[0],par.cell,reg); 
+      registrationOut(reg,par.basename); 
+    }
+
+  std::vector<SampleSummary> layerSummaries; 
+  for(unsigned int l = 0; l < tasks.size(); l++)
+    layerSummaries.push_back(tasks[l].summary); 
+  mergeLayerSummaries(layerSummaries,summary); 
+  if((par.cache && !cached && !hit) || (!cachefile.empty() && !hit))
+    {
+      rings.clear(); 
+      for(unsigned int l = 0; l < tasks.size(); l++)
+	rings.insert(rings.end(),tasks[l].rings.begin(),tasks[l].rings.end()); 
+      if(par.cache && !cached)
+	writeGraphCache(bilayer,par.cell,rings,summary,par.basename); 
+      if(!cachefile.empty())
+	writeGraphCache(bilayer,par.cell,rings,summary,cachefile); 
+    }
+  return summary.status; 
+}//analyzeSample()
+
+/*
+  finishOutputs, waits until the output files are written, then prints
+  and writes the profile and the memory report 
+  @param profile, JSON file of the profile 
+  @param memory, JSON file of the memory report 
+  @return 0, -1 if an output file could not be written 
+*/
+int finishOutputs(string profile, string memory)
+{
+  ProfileTimer flush(PROF_FLUSH); 
+  int status = outputFlush(); 
+  flush.stop(); 
+  if(profileEnabled)
+    profileOut(profile); 
+  if(memoryEnabled)
+    memoryOut(memory); 
+  if((profileEnabled || memoryEnabled) && outputFlush() != 0)
+    status = -1; 
+  return status; 
+}//finishOutputs()
+
+int main(int argc, char *argv[])
+{
+  
+  //--profile[=file.json] times the stages and counts their work, 
+  //--memory-report[=file.json] tracks the bytes of the structures, 
+  //--log=level, --quiet and --verbose set the level of the messages 
+  string profile = "profile.json"; 
+  string memory = "memory.json"; 
+  while(argc > 1 && string(argv[1]).compare(0,2,"--") == 0)
+    {
+      string option = argv[1]; 
+      size_t eq = option.find('='); 
+      if(option.compare(0,eq,"--profile") == 0)
+	{
+	  profileEnabled = true; 
+	  if(eq != string::npos)
+	    profile = option.substr(eq + 1); 
+	}
+      else if(option.compare(0,eq,"--memory-report") == 0)
+	{
+	  memoryEnabled = true; 
+	  if(eq != string::npos)
+	    memory = option.substr(eq + 1); 
+	}
+      else if(option.compare(0,eq,"--log") == 0 && eq != string::npos)
+	{
+	  logLevel = parseLogLevel(option.substr(eq + 1).c_str()); 
+	  if(logLevel < 0)
+	    {
+	      std::cerr << "Log level must be error, warn, info or debug: " << option << std::endl; 
+	      return 1; 
+	    }
+	}
+      else if(option == "--quiet")
+	logLevel = LOG_WARN; 
+      else if(option == "--verbose")
+	logLevel = LOG_DEBUG; 
+      else
+	{
+	  std::cerr << "Unknown option: " << option << std::endl; 
+	  return 1; 
+	}
+      argv++; 
+      argc--; 
+    }
+  if(logLevel > LOG_MAX_LEVEL)
+    LOG(LOG_WARN) << "Debug messages are compiled out, build with -DLOG_MAX_LEVEL=3 to print them" << std::endl; 
+
+  if ( argc == 2 && string(argv[1]) == "-test" )
+    return runTests() ? 1 : 0; 
+
+  if ( argc >= 3 && string(argv[1]) == "-batch" )
+    {
+      int nthreads = 0; 
+      if(argc > 3)
+	nthreads = atoi(argv[3]); 
+      int status = runBatch(argv[2],nthreads); 
+      //the output files are written behind the analysis 
+      if(finishOutputs(profile,memory) != 0)
+	status = 1; 
+      return status; 
+    }
+
+  if ( argc < 3 )
+    {
+      std::cerr << "Not enough input arguments: " << argc << std::endl; 
+      std::cout << "./main.e coordinates.xyz coordinates.xml coordinates.con" << std::endl; 
+      std::cout << "./main.e network.coord coordinates.xml [network.connect]" << std::endl; 
+      std::cout << "./main.e basename.bgc coordinates.xml" << std::endl; 
+      std::cout << "./main.e -batch manifest.txt [nthreads]" << std::endl; 
+      std::cout << "./main.e -test" << std::endl; 
+      std::cout << "--profile[=file.json] before the arguments times the stages" << std::endl; 
+      std::cout << "--memory-report[=file.json] before the arguments reports the memory of the structures" << std::endl; 
+      std::cout << "--log=error|warn|info|debug, --quiet or --verbose before the arguments sets the messages printed" << std::endl; 
+      exit(1);  
+    }
+  
+  LOG(LOG_DEBUG) << "Number of input arguments is: " << argc << std::endl; 
+  for(int i = 0; i < argc; i++)
+    LOG(LOG_DEBUG) << "argv[" << i << "]: " << argv[i] << std::endl; 
+ 
+  SampleSummary summary; 
+  int status = analyzeSample(argv[1],argv[2],argc == 4 ? argv[3] : NULL,summary); 
+  if(finishOutputs(profile,memory) != 0)
+    {
+      std::cerr << "Failed to write the output of " << argv[1] << std::endl; 
+      exit(1); 
+    }
+  if(status != 0)
+    {
+      std::cerr << "Failed to analyze " << argv[1] << ": " << summary.error << std::endl; 
+      exit(1); 
+    }
   
   return 0; 
-}//main()
+}//main()
\ No newline at end of file
@@ -0,0 +1,112 @@
+//npyout.cpp 
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+
+#include "vertex.h"
+#include "ringgeom.h"
+#include "bondstats.h"
+#include "npyout.h"
+#include "asyncwriter.h"
+
+/*
+  npyWrite, writes an array in the NumPy .npy format, version 1.0: the
+  magic string, the length of the header and a header dictionary padded
+  to 64 bytes, then the raw data in C order, so numpy.load can map it 
+  @param file, name of the .npy file 
+  @param type, kind and size of the items, as i4, f4 or f8 
+  @param rows, length of the array 
+  @param cols, columns of a 2D array, 0 for a 1D array 
+  @param data, the items in host byte order 
+  @param itemsize, bytes of an item 
+  @return 0 on success, -1 if the file could not be written 
+*/
+int npyWrite(string file, const char *type, int rows, int cols, const void *data, int itemsize)
+{
+  int one = 1; 
+  char order = *(char*)&one ? '<' : '>'; 
+  char dict[128]; 
+  if(cols > 0)
+    sprintf(dict,"{'descr': '%c%s', 'fortran_order': False, 'shape': (%d, %d), }",order,type,rows,cols); 
+  else
+    sprintf(dict,"{'descr': '%c%s', 'fortran_order': False, 'shape': (%d,), }",order,type,rows); 
+  //magic, version and header length take 10 bytes, the header ends with a newline 
+  int len = strlen(dict); 
+  int header = (10 + len + 1 + 63)/64*64 - 10; 
+  string text(dict); 
+  text.append(header - len - 1,' '); 
+  text.append(1,'\n'); 
+
+  FILE *out; 
+  out = outputOpen(file); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write: " << file << std::endl; 
+      return -1; 
+    }
+  unsigned char magic[10] = {0x93,'N','U','M','P','Y',1,0,(unsigned char)(header & 0xff),(unsigned char)(header >> 8)}; 
+  fwrite(magic,1,10,out); 
+  fwrite(text.c_str(),1,text.size(),out); 
+  size_t items = (size_t)rows*(cols > 0 ? cols : 1); 
+  if(items > 0)
+    fwrite(data,itemsize,items,out); 
+  outputClose(out); 
+  return 0; 
+}//npyWrite()
+
+/*
+  ringNpy, the rings as arrays: the size and area of each ring, in the
+  order of basename_ringdist.dat, and the vertices of the rings as
+  offsets (nrings+1) into the vertex indices 
+  @param sortedCycles, rings sorted in the order that they are connected 
+  @param geometry, geometry of each ring 
+  @param nfile, basename of the output files 
+*/
+void ringNpy(std::vector<std::vector<Vertex*> > &sortedCycles, RingGeometry &geometry, string nfile)
+{
+  int nrings = sortedCycles.size(); 
+  std::vector<int> size(nrings), offset(nrings+1,0), index; 
+  for(int i = 0; i < nrings; i++)
+    {
+      size[i] = sortedCycles[i].size(); 
+      for(unsigned int j = 0; j < sortedCycles[i].size(); j++)
+	index.push_back(sortedCycles[i][j]->index); 
+      offset[i+1] = index.size(); 
+    }
+  npyWrite(nfile+"_ringsize.npy","i4",nrings,0,nrings ? &size[0] : NULL,sizeof(int)); 
+  npyWrite(nfile+"_ringarea.npy","f4",nrings,0,nrings ? &geometry.area[0] : NULL,sizeof(float)); 
+  npyWrite(nfile+"_ringoffset.npy","i4",nrings+1,0,&offset[0],sizeof(int)); 
+  npyWrite(nfile+"_ringindex.npy","i4",index.size(),0,index.empty() ? NULL : &index[0],sizeof(int)); 
+}//ringNpy()
+
+/*
+  aboavNpy, the rows of basename_AboavStack.dat as a 2D array, the
+  average size of the neighbors of each ring at the column of its size 
+  @param aboavStack, neighbor averages of each ring 
+  @param nfile, basename of the output files 
+*/
+void aboavNpy(std::vector<std::vector<double> > &aboavStack, string nfile)
+{
+  int rows = aboavStack.size(); 
+  int cols = rows ? aboavStack[0].size() : 0; 
+  std::vector<double> data; 
+  data.reserve((size_t)rows*cols); 
+  for(int i = 0; i < rows; i++)
+    {
+      data.insert(data.end(),aboavStack[i].begin(),aboavStack[i].end()); 
+      data.resize((size_t)(i+1)*cols,0.); 
+    }
+  npyWrite(nfile+"_AboavStack.npy","f8",rows,cols,data.empty() ? NULL : &data[0],sizeof(double)); 
+}//aboavNpy()
+
+/*
+  bondNpy, the length of every bond 
+  @param stats, bond statistics with the length of each bond 
+  @param nfile, basename of the output files 
+*/
+void bondNpy(BondStats &stats, string nfile)
+{
+  npyWrite(nfile+"_bondlength.npy","f4",stats.length.size(),0,stats.length.empty() ? NULL : &stats.length[0],sizeof(float)); 
+}//bondNpy()
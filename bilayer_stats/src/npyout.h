@@ -0,0 +1,17 @@
+//npyout.h 
+#ifndef _NPYOUT_H
+#define _NPYOUT_H
+
+#include <vector>
+#include <string>
+
+#include "vertex.h"
+#include "ringgeom.h"
+#include "bondstats.h"
+
+int npyWrite(string file, const char *type, int rows, int cols, const void *data, int itemsize); 
+void ringNpy(std::vector<std::vector<Vertex*> > &sortedCycles, RingGeometry &geometry, string nfile="bilayer"); 
+void aboavNpy(std::vector<std::vector<double> > &aboavStack, string nfile="bilayer"); 
+void bondNpy(BondStats &stats, string nfile="bilayer"); 
+
+#endif 
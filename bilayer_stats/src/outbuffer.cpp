@@ -0,0 +1,126 @@
+//outbuffer.cpp 
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+#include "outbuffer.h"
+
+/*
+  Constructor for OutBuffer, the file stays owned by the caller 
+  @param outIn, open file 
+  @param size, bytes buffered before a write 
+ */
+OutBuffer::OutBuffer(FILE *outIn, size_t size) : out(outIn), data(size < 64 ? 64 : size), used(0)
+{
+}//OutBuffer()
+
+/*
+  Destructor for OutBuffer, writes what is left 
+ */
+OutBuffer::~OutBuffer()
+{
+  flush(); 
+}//~OutBuffer()
+
+/*
+  flush, writes the buffer to the file 
+*/
+void OutBuffer::flush()
+{
+  if(used > 0 && out != NULL)
+    fwrite(&data[0],1,used,out); 
+  used = 0; 
+}//flush()
+
+/*
+  put, appends a string 
+*/
+void OutBuffer::put(const char *text)
+{
+  size_t n = strlen(text); 
+  if(used + n > data.size())
+    {
+      flush(); 
+      if(n > data.size())
+	{
+	  fwrite(text,1,n,out); 
+	  return; 
+	}
+    }
+  memcpy(&data[used],text,n); 
+  used += n; 
+}//put()
+
+/*
+  put, appends a character 
+*/
+void OutBuffer::put(char c)
+{
+  if(used == data.size())
+    flush(); 
+  data[used++] = c; 
+}//put()
+
+/*
+  putInt, appends an integer in decimal 
+*/
+void OutBuffer::putInt(int value)
+{
+  char text[16]; 
+  char *p = text + sizeof(text); 
+  *--p = 0; 
+  unsigned int u = value < 0 ? 0u - (unsigned int)value : (unsigned int)value; 
+  do
+    {
+      *--p = '0' + u % 10; 
+      u /= 10; 
+    }
+  while(u > 0); 
+  if(value < 0)
+    *--p = '-'; 
+  put(p); 
+}//putInt()
+
+/*
+  putFloat, appends a float with six decimals, the same text as printf
+  %f. A float times 10^6 is exact in a double, so rounding the product
+  half to even gives the digits printf gives. Values too large for the
+  integer digits and NaN go through printf. 
+*/
+void OutBuffer::putFloat(float value)
+{
+  double v = fabs((double)value)*1e6; 
+  if(!(v < 4.0e9))
+    {
+      char text[64]; 
+      sprintf(text,"%f",value); 
+      put(text); 
+      return; 
+    }
+  double r = floor(v); 
+  double d = v - r; 
+  if(d > 0.5 || (d == 0.5 && fmod(r,2.0) == 1.0))
+    r += 1.0; 
+  unsigned long digits = (unsigned long)r; 
+  unsigned long whole = digits/1000000; 
+  unsigned long frac = digits%1000000; 
+
+  char text[32]; 
+  char *p = text + sizeof(text); 
+  *--p = 0; 
+  for(int i = 0; i < 6; i++)
+    {
+      *--p = '0' + frac % 10; 
+      frac /= 10; 
+    }
+  *--p = '.'; 
+  do
+    {
+      *--p = '0' + whole % 10; 
+      whole /= 10; 
+    }
+  while(whole > 0); 
+  if(value < 0 || (value == 0 && 1/value < 0))
+    *--p = '-'; 
+  put(p); 
+}//putFloat()
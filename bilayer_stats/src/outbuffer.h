@@ -0,0 +1,29 @@
+//outbuffer.h 
+#ifndef _OUTBUFFER_H
+#define _OUTBUFFER_H
+
+#include <vector>
+#include <cstdio>
+
+/*
+  Buffered text output to a file, written in large blocks. Floats are
+  formatted like printf %f without going through printf. 
+ */
+class OutBuffer
+{
+  FILE *out; 
+  std::vector<char> data; 
+  size_t used; 
+  OutBuffer(const OutBuffer&); 
+  OutBuffer& operator=(const OutBuffer&); 
+ public:
+  OutBuffer(FILE *outIn, size_t size=1<<20); 
+  ~OutBuffer(); 
+  void put(const char *text); 
+  void put(char c); 
+  void putInt(int value); 
+  void putFloat(float value); 
+  void flush(); 
+};
+
+#endif 
@@ -0,0 +1,133 @@
+//pdf.cpp 
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+
+#include "vertex.h"
+#include "cell.h"
+#include "celllist.h"
+#include "pdf.h"
+#include "asyncwriter.h"
+
+/*
+  Bins of the pair distance histogram 
+ */
+static const int PDF_BINS = 200; 
+
+/*
+  Bins on each side of the smoothing window, and the rise or fall,
+  relative to the largest value, that makes a peak or a minimum
+ */
+static const int PDF_SMOOTH = 2; 
+static const float PDF_TOLERANCE = 0.05; 
+
+/*
+  pairDistribution, histogram of the distances between the vertices
+  closer than range, found with a cell list in one pass over the
+  vertices, and the bond cutoff at its first minimum. The counts are
+  divided by the radius, the shell of a sheet, and smoothed over five
+  bins. The first peak is the first maximum reaching half of the largest
+  value, the cutoff is at the minimum that follows it, in the middle of
+  a gap without pairs. 
+  @param vertices, the vertices 
+  @param cell, periodic cell 
+  @param range, largest distance of the histogram 
+  @param pdf, the histogram, peak and cutoff 
+*/
+void pairDistribution(std::vector<Vertex*> &vertices, const Cell &cell, float range, PairDistribution &pdf)
+{
+  pdf.range = range; 
+  pdf.width = range/PDF_BINS; 
+  pdf.count.assign(PDF_BINS,0); 
+  pdf.g.assign(PDF_BINS,0); 
+  pdf.peak = 0; 
+  pdf.cutoff = 0; 
+
+  CellList cells; 
+  buildCellList(vertices,range,cell,cells); 
+  std::vector<Vertex*> neighbors; 
+  for(unsigned int i = 0; i < vertices.size(); i++)
+    {
+      Vertex *v = vertices[i]; 
+      cellNeighbors(cells,v->x,v->y,v->z,neighbors); 
+      for(unsigned int n = 0; n < neighbors.size(); n++)
+	{
+	  if(neighbors[n]->index <= v->index)
+	    continue; 
+	  float dx = neighbors[n]->x - v->x, dy = neighbors[n]->y - v->y, dz = neighbors[n]->z - v->z; 
+	  if(cell.periodic())
+	    cellMinimumVector(cell,dx,dy,dz); 
+	  int b = (int)(sqrt(dx*dx + dy*dy + dz*dz)/pdf.width); 
+	  if(b < PDF_BINS)
+	    pdf.count[b]++; 
+	}
+    }
+
+  std::vector<float> g(PDF_BINS); 
+  float gmax = 0; 
+  for(int b = 0; b < PDF_BINS; b++)
+    g[b] = pdf.count[b]/((b + 0.5)*pdf.width); 
+  for(int b = 0; b < PDF_BINS; b++)
+    {
+      float sum = 0; 
+      int n = 0; 
+      for(int c = std::max(0,b - PDF_SMOOTH); c <= std::min(PDF_BINS - 1,b + PDF_SMOOTH); c++)
+	{
+	  sum += g[c]; 
+	  n++; 
+	}
+      pdf.g[b] = sum/n; 
+      if(pdf.g[b] > gmax)
+	gmax = pdf.g[b]; 
+    }
+  if(gmax == 0)
+    return; 
+
+  //climb to the peak and descend to the minimum, ignoring wiggles of
+  //the noise smaller than the tolerance 
+  float tolerance = PDF_TOLERANCE*gmax; 
+  int b = 0; 
+  while(b < PDF_BINS && pdf.g[b] < 0.5*gmax)
+    b++; 
+  int p = b; 
+  for(; b < PDF_BINS && pdf.g[b] > pdf.g[p] - tolerance; b++)
+    if(pdf.g[b] > pdf.g[p])
+      p = b; 
+  pdf.peak = (p + 0.5)*pdf.width; 
+  int m = p, last = p; 
+  for(b = p; b < PDF_BINS && pdf.g[b] < pdf.g[m] + tolerance; b++)
+    {
+      if(pdf.g[b] < pdf.g[m])
+	m = b; 
+      if(pdf.g[b] == pdf.g[m])
+	last = b; 
+    }
+  if(b == PDF_BINS)
+    return; 
+  //the middle of the bins as low as the minimum, a gap without pairs 
+  pdf.cutoff = (0.5*(m + last) + 0.5)*pdf.width; 
+}//pairDistribution()
+
+/*
+  pdfOut, the pair distance histogram, one bin per line: radius, pairs
+  and the smoothed count over the radius, with the peak and cutoff in
+  the header 
+  @param pdf, the histogram 
+  @param nfile, basename of the output file 
+*/
+void pdfOut(PairDistribution &pdf, string nfile)
+{
+  FILE *out; 
+  out = outputOpen(nfile+"_pdf.dat"); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write" << std::endl; 
+      return; 
+    }
+  fprintf(out,"# peak %f cutoff %f\n",pdf.peak,pdf.cutoff); 
+  for(unsigned int b = 0; b < pdf.count.size(); b++)
+    fprintf(out,"%f %ld %f\n",(b + 0.5)*pdf.width,pdf.count[b],pdf.g[b]); 
+  outputClose(out); 
+}//pdfOut()
@@ -0,0 +1,28 @@
+//pdf.h 
+#ifndef _PDF_H
+#define _PDF_H
+
+#include <vector>
+#include <string>
+
+#include "vertex.h"
+#include "cell.h"
+
+/*
+  Histogram of the pair distances of a sample up to range, and the bond
+  cutoff picked from it 
+ */
+struct PairDistribution
+{
+  float range; 
+  float width;                 //width of a bin 
+  std::vector<long> count;     //pairs in each bin 
+  std::vector<float> g;        //count over the radius, smoothed over five bins 
+  float peak;                  //first peak 
+  float cutoff;                //first minimum after the peak, 0 if none 
+};
+
+void pairDistribution(std::vector<Vertex*> &vertices, const Cell &cell, float range, PairDistribution &pdf); 
+void pdfOut(PairDistribution &pdf, string nfile="bilayer"); 
+
+#endif 
@@ -0,0 +1,239 @@
+//profile.cpp 
+#include <iostream>
+#include <cstdio>
+#include <string>
+#include <pthread.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "asyncwriter.h"
+#include "profile.h"
+
+bool profileEnabled = false; 
+bool memoryEnabled = false; 
+
+static const char *stageNames[NPROFILESTAGES] = {
+  "read", "bond", "contract", "rings", "secondSort", "sort", "geometry", "bonds", "aboav", "fits", "flush"
+}; 
+
+static const char *counterNames[NPROFILECOUNTERS] = {
+  "bfs_paths", "self_intersecting", "duplicates", "secondsort_removed", "pbc_rings", "distance_bonds"
+}; 
+
+static const char *memoryNames[NMEMORYITEMS] = {
+  "vertices", "edges", "candidate_paths", "rings", "incidence", "geometry", "aboav_stack"
+}; 
+
+/*
+  Totals of the profile, shared by all threads 
+ */
+struct ProfileTotals
+{
+  pthread_mutex_t lock; 
+  double wall[NPROFILESTAGES]; 
+  double cpu[NPROFILESTAGES]; 
+  long calls[NPROFILESTAGES]; 
+  long count[NPROFILECOUNTERS]; 
+  long maxrss[NPROFILESTAGES];        //peak RSS at the end of the stage, KB 
+  long rssgrowth[NPROFILESTAGES];     //rise of the peak RSS during the stage, KB 
+  size_t last[NMEMORYITEMS];          //bytes of the latest note 
+  size_t peak[NMEMORYITEMS];          //largest note 
+}; 
+
+static ProfileTotals totals = {PTHREAD_MUTEX_INITIALIZER,{0},{0},{0},{0},{0},{0},{0},{0}}; 
+
+/*
+  seconds of a clock 
+ */
+static double clockSeconds(clockid_t clock)
+{
+  struct timespec t; 
+  clock_gettime(clock,&t); 
+  return t.tv_sec + 1e-9*t.tv_nsec; 
+}
+
+/*
+  profileAdd, adds work to a counter 
+  @param counter, the counter 
+  @param n, work done 
+*/
+void profileAdd(ProfileCounter counter, long n)
+{
+  pthread_mutex_lock(&totals.lock); 
+  totals.count[counter] += n; 
+  pthread_mutex_unlock(&totals.lock); 
+}//profileAdd()
+
+/*
+  peakRss, high-water mark of the resident memory of the process 
+  @return peak RSS in KB 
+*/
+long peakRss()
+{
+  struct rusage usage; 
+  if(getrusage(RUSAGE_SELF,&usage) != 0)
+    return 0; 
+  return usage.ru_maxrss; 
+}//peakRss()
+
+/*
+  profileTime, adds a call of a stage 
+  @param stage, the stage 
+  @param wall, cpu seconds of the call 
+  @param rss0, rss1 peak RSS at the start and end of the call, KB 
+*/
+void profileTime(ProfileStage stage, double wall, double cpu, long rss0, long rss1)
+{
+  pthread_mutex_lock(&totals.lock); 
+  totals.wall[stage] += wall; 
+  totals.cpu[stage] += cpu; 
+  totals.calls[stage]++; 
+  if(rss1 > totals.maxrss[stage])
+    totals.maxrss[stage] = rss1; 
+  totals.rssgrowth[stage] += rss1 - rss0; 
+  pthread_mutex_unlock(&totals.lock); 
+}//profileTime()
+
+/*
+  memoryNote, records the bytes of a structure 
+  @param item, the structure 
+  @param bytes, its size now 
+*/
+void memoryNote(MemoryItem item, size_t bytes)
+{
+  pthread_mutex_lock(&totals.lock); 
+  totals.last[item] = bytes; 
+  if(bytes > totals.peak[item])
+    totals.peak[item] = bytes; 
+  pthread_mutex_unlock(&totals.lock); 
+}//memoryNote()
+
+/*
+  Constructor for ProfileTimer, starts the clocks when profiling 
+ */
+ProfileTimer::ProfileTimer(ProfileStage stageIn) : stage(stageIn), running(profileEnabled || memoryEnabled), wall(0), cpu(0), rss(0)
+{
+  if(running)
+    {
+      wall = clockSeconds(CLOCK_MONOTONIC); 
+      cpu = clockSeconds(CLOCK_THREAD_CPUTIME_ID); 
+      rss = peakRss(); 
+    }
+}//ProfileTimer()
+
+/*
+  Destructor for ProfileTimer, stops a running timer 
+ */
+ProfileTimer::~ProfileTimer()
+{
+  stop(); 
+}//~ProfileTimer()
+
+/*
+  stop, adds the time since the construction to the stage 
+ */
+void ProfileTimer::stop()
+{
+  if(!running)
+    return; 
+  running = false; 
+  profileTime(stage,clockSeconds(CLOCK_MONOTONIC) - wall,clockSeconds(CLOCK_THREAD_CPUTIME_ID) - cpu,rss,peakRss()); 
+}//stop()
+
+/*
+  profileOut, prints the stage times and counters and writes them as JSON 
+  @param file, name of the JSON file 
+*/
+void profileOut(string file)
+{
+  pthread_mutex_lock(&totals.lock); 
+  std::cout << "Profile: stage calls wall(s) cpu(s)" << std::endl; 
+  char line[256]; 
+  for(int s = 0; s < NPROFILESTAGES; s++)
+    {
+      if(totals.calls[s] == 0)
+	continue; 
+      sprintf(line,"  %-12s %6ld %10.4f %10.4f",stageNames[s],totals.calls[s],totals.wall[s],totals.cpu[s]); 
+      std::cout << line << std::endl; 
+    }
+  std::cout << "Profile: counters" << std::endl; 
+  for(int c = 0; c < NPROFILECOUNTERS; c++)
+    {
+      sprintf(line,"  %-20s %12ld",counterNames[c],totals.count[c]); 
+      std::cout << line << std::endl; 
+    }
+
+  FILE *out = outputOpen(file); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write: " << file << std::endl; 
+      pthread_mutex_unlock(&totals.lock); 
+      return; 
+    }
+  fprintf(out,"{\n  \"stages\": {\n"); 
+  bool first = true; 
+  for(int s = 0; s < NPROFILESTAGES; s++)
+    {
+      if(totals.calls[s] == 0)
+	continue; 
+      fprintf(out,"%s    \"%s\": {\"calls\": %ld, \"wall\": %.6f, \"cpu\": %.6f}",first ? "" : ",\n",
+	      stageNames[s],totals.calls[s],totals.wall[s],totals.cpu[s]); 
+      first = false; 
+    }
+  fprintf(out,"\n  },\n  \"counters\": {\n"); 
+  for(int c = 0; c < NPROFILECOUNTERS; c++)
+    fprintf(out,"    \"%s\": %ld%s\n",counterNames[c],totals.count[c],c + 1 < NPROFILECOUNTERS ? "," : ""); 
+  fprintf(out,"  }\n}\n"); 
+  outputClose(out); 
+  pthread_mutex_unlock(&totals.lock); 
+}//profileOut()
+
+/*
+  memoryOut, prints the bytes of the structures and the peak RSS of the
+  stages and writes them as JSON 
+  @param file, name of the JSON file 
+*/
+void memoryOut(string file)
+{
+  pthread_mutex_lock(&totals.lock); 
+  char line[256]; 
+  std::cout << "Memory: structure last peak (bytes)" << std::endl; 
+  for(int m = 0; m < NMEMORYITEMS; m++)
+    {
+      sprintf(line,"  %-16s %14lu %14lu",memoryNames[m],(unsigned long)totals.last[m],(unsigned long)totals.peak[m]); 
+      std::cout << line << std::endl; 
+    }
+  std::cout << "Memory: stage peak RSS, rise during the stage (KB)" << std::endl; 
+  for(int s = 0; s < NPROFILESTAGES; s++)
+    {
+      if(totals.calls[s] == 0)
+	continue; 
+      sprintf(line,"  %-12s %10ld %10ld",stageNames[s],totals.maxrss[s],totals.rssgrowth[s]); 
+      std::cout << line << std::endl; 
+    }
+
+  FILE *out = outputOpen(file); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write: " << file << std::endl; 
+      pthread_mutex_unlock(&totals.lock); 
+      return; 
+    }
+  fprintf(out,"{\n  \"structures\": {\n"); 
+  for(int m = 0; m < NMEMORYITEMS; m++)
+    fprintf(out,"    \"%s\": {\"last\": %lu, \"peak\": %lu}%s\n",memoryNames[m],(unsigned long)totals.last[m],
+	    (unsigned long)totals.peak[m],m + 1 < NMEMORYITEMS ? "," : ""); 
+  fprintf(out,"  },\n  \"stages\": {\n"); 
+  bool first = true; 
+  for(int s = 0; s < NPROFILESTAGES; s++)
+    {
+      if(totals.calls[s] == 0)
+	continue; 
+      fprintf(out,"%s    \"%s\": {\"peak_rss_kb\": %ld, \"rss_rise_kb\": %ld}",first ? "" : ",\n",
+	      stageNames[s],totals.maxrss[s],totals.rssgrowth[s]); 
+      first = false; 
+    }
+  fprintf(out,"\n  },\n  \"peak_rss_kb\": %ld\n}\n",peakRss()); 
+  outputClose(out); 
+  pthread_mutex_unlock(&totals.lock); 
+}//memoryOut()
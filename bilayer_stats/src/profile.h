@@ -0,0 +1,116 @@
+//profile.h
+#ifndef _PROFILE_H
+#define _PROFILE_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+  Stages timed by the profile, wall and CPU time of the thread summed
+  over all calls
+ */
+enum ProfileStage
+{
+  PROF_READ,            //coordinates, Leiden or cache files
+  PROF_BOND,            //connectAtoms and the connectivity file
+  PROF_CONTRACT,        //Si-O-Si bridges
+  PROF_RINGS,           //ring BFS of every vertex
+  PROF_SECONDSORT,      //rings made of smaller rings
+  PROF_SORT,            //vertices of each ring in ring order
+  PROF_GEOMETRY,        //unwrapped coordinates and ring shapes
+  PROF_BONDS,           //bond length statistics
+  PROF_ABOAV,           //neighboring rings
+  PROF_FITS,            //Lewis, Aboav-Weaire and area law fits
+  PROF_FLUSH,           //waiting for the output files to be written
+  NPROFILESTAGES
+};
+
+/*
+  Work counted by the profile
+ */
+enum ProfileCounter
+{
+  PROF_BFS_PATHS,          //paths expanded in findCyclesToSelf
+  PROF_SELF_INTERSECTING,  //candidate rings visiting a vertex twice
+  PROF_DUPLICATES,         //rings found again and dropped by AddNoRepeats
+  PROF_SECONDSORT_REMOVED, //rings removed by secondSort
+  PROF_PBC_RINGS,          //rings across the periodic box dropped by PolygonPBC
+  PROF_DISTANCE_BONDS,     //bonds made by connectAtoms or connectNearest
+  NPROFILECOUNTERS
+};
+
+/*
+  Structures tracked by the memory report, in bytes
+ */
+enum MemoryItem
+{
+  MEM_VERTICES,         //vertices and bridges of the graph
+  MEM_EDGES,            //edge, image and bridge lists of the vertices
+  MEM_PATHS,            //candidate paths of the ring BFS of a vertex
+  MEM_RINGS,            //ring list and sorted rings
+  MEM_INCIDENCE,        //rings of each vertex, Vertex::rings
+  MEM_GEOMETRY,         //unwrapped ring coordinates and ring shapes
+  MEM_ABOAV,            //Aboav stack
+  NMEMORYITEMS
+};
+
+extern bool profileEnabled;
+extern bool memoryEnabled;
+
+void profileAdd(ProfileCounter counter, long n);
+void profileTime(ProfileStage stage, double wall, double cpu, long rss0, long rss1);
+void profileOut(string file);
+void memoryNote(MemoryItem item, size_t bytes);
+void memoryOut(string file);
+long peakRss();
+
+/*
+  Bytes held by a vector and by a vector of vectors
+ */
+template <class T>
+size_t vectorBytes(const std::vector<T> &v)
+{
+  return v.capacity()*sizeof(T);
+}
+
+template <class T>
+size_t nestedBytes(const std::vector<std::vector<T> > &v)
+{
+  size_t bytes = vectorBytes(v);
+  for(unsigned int i = 0; i < v.size(); i++)
+    bytes += vectorBytes(v[i]);
+  return bytes;
+}
+
+/*
+  profileCount, adds work to a counter when profiling. Hot loops count
+  in a local variable and report once, so a disabled profile costs a
+  branch per call.
+ */
+inline void profileCount(ProfileCounter counter, long n)
+{
+  if(profileEnabled)
+    profileAdd(counter,n);
+}
+
+/*
+  Times a stage from its construction to stop() or its destruction, and
+  records the peak RSS at its end for the memory report
+ */
+class ProfileTimer
+{
+  ProfileStage stage;
+  bool running;
+  double wall, cpu;
+  long rss;
+  ProfileTimer(const ProfileTimer&);
+  ProfileTimer& operator=(const ProfileTimer&);
+ public:
+  ProfileTimer(ProfileStage stageIn);
+  ~ProfileTimer();
+  void stop();
+};
+
+#endif
@@ -0,0 +1,622 @@
+//render.cpp 
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "ringgeom.h"
+#include "cell.h"
+#include "outbuffer.h"
+#include "render.h"
+#include "asyncwriter.h"
+#include "threadbudget.h"
+#include "log.h"
+
+/*
+  ringColor, color of a ring size, the colors of polygonGraphics
+  starting at 4 rings and repeating past the end of the list
+  @param n, ring size 
+  @return red, green and blue of the color 
+*/
+const unsigned char* ringColor(int n)
+{
+  static const unsigned char colors[][3] = {
+    {0,0,255},       //Blue
+    {0,0,0},         //Black
+    {255,255,0},     //Yellow
+    {0,255,0},       //Green
+    {255,0,0},       //Red
+    {128,0,128},     //Purple
+    {0,255,255},     //Cyan
+    {255,128,0},     //Orange
+    {255,128,128},   //Pink
+    {153,102,51},    //Brown
+    {128,128,128},   //Gray
+    {255,0,255},     //Magenta
+    {222,240,255},   //LightBlue
+    {224,255,224}    //LightGreen
+  }; 
+  const int ncolors = sizeof(colors)/sizeof(colors[0]); 
+  return colors[((n-4)%ncolors+ncolors)%ncolors]; 
+}//ringColor()
+
+/*
+  rowCrossings, the x where a polygon crosses the horizontal line at y,
+  sorted, an edge counts from its upper end up to its lower end
+  @param x, y vertices of the polygon 
+  @param n, number of vertices 
+  @param yc, height of the line 
+  @param xs, filled with the crossings 
+*/
+void rowCrossings(const float *x, const float *y, int n, float yc, std::vector<float> &xs)
+{
+  xs.clear(); 
+  for(int k = 0; k < n; k++)
+    {
+      int l = (k + 1) % n; 
+      if((y[k] <= yc && yc < y[l]) || (y[l] <= yc && yc < y[k]))
+	xs.push_back(x[k] + (yc - y[k])*(x[l] - x[k])/(y[l] - y[k])); 
+    }
+  std::sort(xs.begin(),xs.end()); 
+}//rowCrossings()
+
+/*
+  buildRenderScene, places the rings in pixel coordinates. The picture
+  is the periodic cell, from the lowest vertex of the rings along a and
+  b, or the bounding box of the rings without a periodic cell.
+  @param coords, unwrapped ring coordinates 
+  @param cell, periodic cell 
+  @param ringmin, ringmax range of ring sizes drawn 
+  @param width, width of the picture in pixels 
+  @param scene, filled with the polygons 
+*/
+void buildRenderScene(RingCoords &coords, const Cell &cell, int ringmin, int ringmax, int width, RenderScene &scene)
+{
+  std::vector<float> wx, wy; 
+  std::vector<int> wstart(1,0), wsize, wring; 
+  int nsize = coords.count.size(); 
+  for(int n = ringmin; n <= ringmax && n < nsize; n++)
+    for(int c = 0; c < coords.count[n]; c++)
+      {
+	int i = coords.ring[coords.start[n] + c]; 
+	for(int k = 0; k < n; k++)
+	  {
+	    wx.push_back(coords.x[coords.offset[n] + k*coords.stride[n] + c] + coords.ox[i]); 
+	    wy.push_back(coords.y[coords.offset[n] + k*coords.stride[n] + c] + coords.oy[i]); 
+	  }
+	wstart.push_back(wx.size()); 
+	wsize.push_back(n); 
+	wring.push_back(i); 
+      }
+
+  scene.periodic = cell.periodic(); 
+  float X0 = 0, X1 = 1, Y0 = 0, Y1 = 1; 
+  float ox = 0, oy = 0; 
+  if(scene.periodic)
+    {
+      for(unsigned int p = 0; p < wring.size(); p++)
+	{
+	  if(p == 0 || coords.ox[wring[p]] < ox) ox = coords.ox[wring[p]]; 
+	  if(p == 0 || coords.oy[wring[p]] < oy) oy = coords.oy[wring[p]]; 
+	}
+      float cx[4] = {ox, ox + cell.ax, ox + cell.ax + cell.bx, ox + cell.bx}; 
+      float cy[4] = {oy, oy + cell.ay, oy + cell.ay + cell.by, oy + cell.by}; 
+      X0 = X1 = cx[0]; 
+      Y0 = Y1 = cy[0]; 
+      for(int k = 1; k < 4; k++)
+	{
+	  X0 = std::min(X0,cx[k]); X1 = std::max(X1,cx[k]); 
+	  Y0 = std::min(Y0,cy[k]); Y1 = std::max(Y1,cy[k]); 
+	}
+    }
+  else if(!wx.empty())
+    {
+      X0 = *std::min_element(wx.begin(),wx.end()); 
+      X1 = *std::max_element(wx.begin(),wx.end()); 
+      Y0 = *std::min_element(wy.begin(),wy.end()); 
+      Y1 = *std::max_element(wy.begin(),wy.end()); 
+      if(X1 <= X0) X1 = X0 + 1; 
+      if(Y1 <= Y0) Y1 = Y0 + 1; 
+    }
+  scene.width = width > 0 ? width : 1; 
+  scene.scale = scene.width/(X1 - X0); 
+  scene.height = std::max(1,(int)ceil((Y1 - Y0)*scene.scale)); 
+  scene.x0 = X0; 
+  scene.y1 = Y1; 
+
+  //every image of a ring that reaches into the picture
+  int nimage = scene.periodic ? 1 : 0; 
+  scene.x.clear(); scene.y.clear(); 
+  scene.start.assign(1,0); 
+  scene.size.clear(); 
+  scene.top.clear(); scene.bottom.clear(); scene.left.clear(); scene.right.clear(); 
+  for(unsigned int p = 0; p < wsize.size(); p++)
+    for(int i = -nimage; i <= nimage; i++)
+      for(int j = -nimage; j <= nimage; j++)
+	{
+	  float sx = i*cell.ax + j*cell.bx, sy = i*cell.ay + j*cell.by; 
+	  float l = 0, r = 0, t = 0, b = 0; 
+	  for(int k = wstart[p]; k < wstart[p+1]; k++)
+	    {
+	      float px = (wx[k] + sx - X0)*scene.scale; 
+	      float py = (Y1 - wy[k] - sy)*scene.scale; 
+	      if(k == wstart[p] || px < l) l = px; 
+	      if(k == wstart[p] || px > r) r = px; 
+	      if(k == wstart[p] || py < t) t = py; 
+	      if(k == wstart[p] || py > b) b = py; 
+	    }
+	  if(r < 0 || l > scene.width || b < 0 || t > scene.height)
+	    continue; 
+	  for(int k = wstart[p]; k < wstart[p+1]; k++)
+	    {
+	      scene.x.push_back((wx[k] + sx - X0)*scene.scale); 
+	      scene.y.push_back((Y1 - wy[k] - sy)*scene.scale); 
+	    }
+	  scene.start.push_back(scene.x.size()); 
+	  scene.size.push_back(wsize[p]); 
+	  scene.left.push_back(l); scene.right.push_back(r); 
+	  scene.top.push_back(t); scene.bottom.push_back(b); 
+	}
+
+  //the span of the cell along each row of pixels
+  float corner[4][2] = {{ox,oy},{ox + cell.ax,oy + cell.ay},{ox + cell.ax + cell.bx,oy + cell.ay + cell.by},{ox + cell.bx,oy + cell.by}}; 
+  float cx[4], cy[4]; 
+  for(int k = 0; k < 4; k++)
+    {
+      cx[k] = scene.cell[k][0] = (corner[k][0] - X0)*scene.scale; 
+      cy[k] = scene.cell[k][1] = (Y1 - corner[k][1])*scene.scale; 
+    }
+  scene.clipleft.assign(scene.height,0); 
+  scene.clipright.assign(scene.height,scene.width); 
+  std::vector<float> xs; 
+  for(int row = 0; scene.periodic && row < scene.height; row++)
+    {
+      rowCrossings(cx,cy,4,row + 0.5f,xs); 
+      scene.clipleft[row] = xs.size() < 2 ? 1 : xs.front(); 
+      scene.clipright[row] = xs.size() < 2 ? 0 : xs.back(); 
+    }
+}//buildRenderScene()
+
+/*
+  rasterize, fills the polygons of a scene and outlines them in black,
+  over the rows row0 to row1-1 of a tile of the picture
+  @param scene, the polygons 
+  @param tx, ty top left pixel of the tile 
+  @param tw, width of the tile 
+  @param row0, row1 rows of the picture drawn 
+  @param rgb, pixels of the tile 
+*/
+void rasterize(RenderScene &scene, int tx, int ty, int tw, int row0, int row1, unsigned char *rgb)
+{
+  std::vector<float> xs; 
+  int npoly = scene.size.size(); 
+  for(int p = 0; p < npoly; p++)
+    {
+      if(scene.bottom[p] < row0 || scene.top[p] > row1 || scene.right[p] < tx || scene.left[p] > tx + tw)
+	continue; 
+      const unsigned char *color = ringColor(scene.size[p]); 
+      const float *x = &scene.x[scene.start[p]]; 
+      const float *y = &scene.y[scene.start[p]]; 
+      int n = scene.start[p+1] - scene.start[p]; 
+      int first = std::max(row0,(int)floor(scene.top[p])); 
+      int last = std::min(row1 - 1,(int)ceil(scene.bottom[p])); 
+      for(int row = first; row <= last; row++)
+	{
+	  rowCrossings(x,y,n,row + 0.5f,xs); 
+	  for(unsigned int k = 0; k + 1 < xs.size(); k += 2)
+	    {
+	      float a = std::max(xs[k],scene.clipleft[row]); 
+	      float b = std::min(xs[k+1],scene.clipright[row]); 
+	      int c0 = std::max(tx,(int)ceil(a - 0.5f)); 
+	      int c1 = std::min(tx + tw,(int)ceil(b - 0.5f)); 
+	      unsigned char *out = rgb + 3*((size_t)(row - ty)*tw + (c0 - tx)); 
+	      for(int c = c0; c < c1; c++, out += 3)
+		{
+		  out[0] = color[0]; 
+		  out[1] = color[1]; 
+		  out[2] = color[2]; 
+		}
+	    }
+	}
+    }
+
+  //outlines after all of the fills, so that no fill covers an edge
+  for(int p = 0; p < npoly; p++)
+    {
+      if(scene.bottom[p] < row0 - 1 || scene.top[p] > row1 + 1 || scene.right[p] < tx - 1 || scene.left[p] > tx + tw + 1)
+	continue; 
+      int n = scene.start[p+1] - scene.start[p]; 
+      for(int k = 0; k < n; k++)
+	{
+	  int l = (k + 1) % n; 
+	  float x1 = scene.x[scene.start[p] + k], y1 = scene.y[scene.start[p] + k]; 
+	  float dx = scene.x[scene.start[p] + l] - x1, dy = scene.y[scene.start[p] + l] - y1; 
+	  int steps = std::max(1,(int)ceil(std::max(fabs(dx),fabs(dy)))); 
+	  for(int s = 0; s <= steps; s++)
+	    {
+	      float fx = x1 + dx*s/steps, fy = y1 + dy*s/steps; 
+	      int c = (int)floor(fx), row = (int)floor(fy); 
+	      if(row < row0 || row >= row1 || c < tx || c >= tx + tw)
+		continue; 
+	      if(c + 0.5f < scene.clipleft[row] || c + 0.5f > scene.clipright[row])
+		continue; 
+	      unsigned char *out = rgb + 3*((size_t)(row - ty)*tw + (c - tx)); 
+	      out[0] = out[1] = out[2] = 0; 
+	    }
+	}
+    }
+}//rasterize()
+
+/*
+  Work shared by the threads rendering a picture. With a single tile
+  each job is a band of rows of the picture, otherwise each job is a
+  tile written to its own file.
+ */
+struct RenderQueue
+{
+  RenderScene *scene; 
+  int tiles; 
+  int tilew, tileh; 
+  int bandrows; 
+  int njobs; 
+  int next; 
+  unsigned char *image; 
+  string nfile; 
+  pthread_mutex_t lock; 
+}; 
+
+/*
+  renderWorker, thread of the render pool
+ */
+void* renderWorker(void *arg)
+{
+  RenderQueue *queue = (RenderQueue*)arg; 
+  RenderScene &scene = *queue->scene; 
+  while(true)
+    {
+      pthread_mutex_lock(&queue->lock); 
+      int job = queue->next++; 
+      pthread_mutex_unlock(&queue->lock); 
+      if(job >= queue->njobs)
+	break; 
+      if(queue->tiles == 1)
+	{
+	  int row0 = job*queue->bandrows; 
+	  int row1 = std::min(scene.height,row0 + queue->bandrows); 
+	  rasterize(scene,0,0,scene.width,row0,row1,queue->image); 
+	  continue; 
+	}
+      int tx = (job % queue->tiles)*queue->tilew; 
+      int ty = (job / queue->tiles)*queue->tileh; 
+      int tw = std::min(queue->tilew,scene.width - tx); 
+      int th = std::min(queue->tileh,scene.height - ty); 
+      if(tw <= 0 || th <= 0)
+	continue; 
+      std::vector<unsigned char> rgb((size_t)3*tw*th,255); 
+      rasterize(scene,tx,ty,tw,ty,ty + th,&rgb[0]); 
+      char name[64]; 
+      sprintf(name,"_poly_%d_%d.png",job / queue->tiles,job % queue->tiles); 
+      writePng(queue->nfile + name,tw,th,&rgb[0]); 
+    }
+  return NULL; 
+}//renderWorker()
+
+/*
+  renderPng, rasterizes the rings to basename_poly.png, or to
+  basename_poly_row_column.png for each of tiles x tiles tiles
+  @param scene, the polygons 
+  @param tiles, tiles along each side of the picture 
+  @param nthreads, largest number of threads, with the calling thread, 
+  as many as the thread budget gives if not positive
+  @param nfile, basename of the output files 
+*/
+void renderPng(RenderScene &scene, int tiles, int nthreads, string nfile)
+{
+  if(tiles < 1)
+    tiles = 1; 
+
+  RenderQueue queue; 
+  std::vector<unsigned char> image; 
+  queue.scene = &scene; 
+  queue.tiles = tiles; 
+  queue.tilew = (scene.width + tiles - 1)/tiles; 
+  queue.tileh = (scene.height + tiles - 1)/tiles; 
+  queue.nfile = nfile; 
+  queue.next = 0; 
+  queue.image = NULL; 
+  if(tiles == 1)
+    {
+      //bands of at least 16 rows, 4 per thread that could help 
+      int nbands = 4*(nthreads > 0 ? nthreads : sysconf(_SC_NPROCESSORS_ONLN)); 
+      image.assign((size_t)3*scene.width*scene.height,255); 
+      queue.image = &image[0]; 
+      queue.bandrows = std::max(16,(scene.height + nbands - 1)/nbands); 
+      queue.njobs = (scene.height + queue.bandrows - 1)/queue.bandrows; 
+    }
+  else
+    {
+      queue.bandrows = queue.tileh; 
+      queue.njobs = tiles*tiles; 
+    }
+  if(nthreads <= 0 || nthreads > queue.njobs)
+    nthreads = queue.njobs; 
+
+  //the calling thread takes jobs with the helpers of the budget 
+  int helpers = threadsAcquire(nthreads - 1); 
+  pthread_mutex_init(&queue.lock,NULL); 
+  std::vector<pthread_t> threads(helpers); 
+  for(int i = 0; i < helpers; i++)
+    pthread_create(&threads[i],NULL,renderWorker,&queue); 
+  renderWorker(&queue); 
+  for(int i = 0; i < helpers; i++)
+    pthread_join(threads[i],NULL); 
+  threadsRelease(helpers); 
+  pthread_mutex_destroy(&queue.lock); 
+
+  if(tiles == 1)
+    writePng(nfile + "_poly.png",scene.width,scene.height,&image[0]); 
+}//renderPng()
+
+/*
+  renderSvg, writes the rings as SVG polygons to basename_poly.svg,
+  clipped to the periodic cell
+  @param scene, the polygons 
+  @param nfile, basename of the output file 
+*/
+void renderSvg(RenderScene &scene, string nfile)
+{
+  string file = nfile + "_poly.svg"; 
+  FILE *out = outputOpen(file); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write: " << file << std::endl; 
+      return; 
+    }
+  OutBuffer buf(out); 
+  char text[256]; 
+  sprintf(text,"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	  "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%d\" height=\"%d\" viewBox=\"0 0 %d %d\">\n",
+	  scene.width,scene.height,scene.width,scene.height); 
+  buf.put(text); 
+  buf.put("<rect width=\"100%\" height=\"100%\" fill=\"white\"/>\n"); 
+  if(scene.periodic)
+    {
+      buf.put("<defs><clipPath id=\"cell\"><polygon points=\""); 
+      for(int k = 0; k < 4; k++)
+	{
+	  buf.putFloat(scene.cell[k][0]); 
+	  buf.put(','); 
+	  buf.putFloat(scene.cell[k][1]); 
+	  buf.put(k < 3 ? ' ' : '"'); 
+	}
+      buf.put("/></clipPath></defs>\n<g clip-path=\"url(#cell)\" stroke=\"black\" stroke-linejoin=\"round\">\n"); 
+    }
+  else
+    buf.put("<g stroke=\"black\" stroke-linejoin=\"round\">\n"); 
+  for(unsigned int p = 0; p < scene.size.size(); p++)
+    {
+      const unsigned char *color = ringColor(scene.size[p]); 
+      sprintf(text,"<polygon fill=\"#%02x%02x%02x\" points=\"",color[0],color[1],color[2]); 
+      buf.put(text); 
+      for(int k = scene.start[p]; k < scene.start[p+1]; k++)
+	{
+	  if(k != scene.start[p])
+	    buf.put(' '); 
+	  buf.putFloat(scene.x[k]); 
+	  buf.put(','); 
+	  buf.putFloat(scene.y[k]); 
+	}
+      buf.put("\"/>\n"); 
+    }
+  buf.put("</g>\n</svg>\n"); 
+  buf.flush(); 
+  outputClose(out); 
+}//renderSvg()
+
+/*
+  Table of the CRC-32 of PNG chunks
+ */
+struct CrcTable
+{
+  unsigned int entry[256]; 
+  CrcTable()
+  {
+    for(unsigned int n = 0; n < 256; n++)
+      {
+	unsigned int c = n; 
+	for(int k = 0; k < 8; k++)
+	  c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1; 
+	entry[n] = c; 
+      }
+  }
+}; 
+
+/*
+  crc32, continues the CRC-32 of a chunk over more bytes, start with
+  0xffffffff and invert at the end
+*/
+unsigned int crc32(unsigned int crc, const unsigned char *data, size_t n)
+{
+  static const CrcTable table; 
+  for(size_t i = 0; i < n; i++)
+    crc = table.entry[(crc ^ data[i]) & 0xff] ^ (crc >> 8); 
+  return crc; 
+}//crc32()
+
+/*
+  adler32, continues the Adler-32 checksum of the zlib stream
+*/
+unsigned int adler32(unsigned int adler, const unsigned char *data, size_t n)
+{
+  unsigned int a = adler & 0xffff, b = adler >> 16; 
+  while(n > 0)
+    {
+      //5552 bytes is the most before the sums can overflow
+      size_t m = n < 5552 ? n : 5552; 
+      n -= m; 
+      while(m--)
+	{
+	  a += *data++; 
+	  b += a; 
+	}
+      a %= 65521; 
+      b %= 65521; 
+    }
+  return (b << 16) | a; 
+}//adler32()
+
+/*
+  Writes a big endian 32 bit integer
+ */
+inline void putBE32(unsigned char *p, unsigned int v)
+{
+  p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v; 
+}//putBE32()
+
+/*
+  PNG chunk written piece by piece, with its CRC
+ */
+struct PngChunk
+{
+  FILE *out; 
+  unsigned int crc; 
+  void begin(const char *type, unsigned int length)
+  {
+    unsigned char head[8]; 
+    putBE32(head,length); 
+    memcpy(head + 4,type,4); 
+    fwrite(head,1,8,out); 
+    crc = ::crc32(0xffffffffu,head + 4,4); 
+  }
+  void put(const unsigned char *data, size_t n)
+  {
+    fwrite(data,1,n,out); 
+    crc = ::crc32(crc,data,n); 
+  }
+  void end()
+  {
+    unsigned char tail[4]; 
+    putBE32(tail,crc ^ 0xffffffffu); 
+    fwrite(tail,1,4,out); 
+  }
+}; 
+
+/*
+  writePng, writes an RGB image as a PNG. The zlib stream is made of
+  stored deflate blocks, so nothing is compressed and the image is
+  written as it is, one row at a time behind its filter byte.
+  @param file, name of the PNG file 
+  @param width, height size of the image 
+  @param rgb, red, green and blue of each pixel, row by row from the top 
+  @return 0 on success, -1 if the file could not be written 
+*/
+int writePng(string file, int width, int height, const unsigned char *rgb)
+{
+  FILE *out = outputOpen(file); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write: " << file << std::endl; 
+      return -1; 
+    }
+  const unsigned char signature[8] = {137,'P','N','G','\r','\n',26,'\n'}; 
+  fwrite(signature,1,8,out); 
+
+  PngChunk chunk; 
+  chunk.out = out; 
+  unsigned char ihdr[13]; 
+  putBE32(ihdr,width); 
+  putBE32(ihdr + 4,height); 
+  ihdr[8] = 8;    //bits per sample
+  ihdr[9] = 2;    //RGB
+  ihdr[10] = ihdr[11] = ihdr[12] = 0; 
+  chunk.begin("IHDR",13); 
+  chunk.put(ihdr,13); 
+  chunk.end(); 
+
+  //stored blocks of at most 65535 bytes over the rows with their filter bytes
+  size_t rowbytes = 3*(size_t)width + 1; 
+  size_t raw = rowbytes*height; 
+  size_t nblocks = raw == 0 ? 1 : (raw + 65534)/65535; 
+  chunk.begin("IDAT",2 + 5*nblocks + raw + 4); 
+  const unsigned char zhead[2] = {0x78,0x01}; 
+  chunk.put(zhead,2); 
+  unsigned int adler = 1; 
+  size_t left = raw, inblock = 0; 
+  const unsigned char filter = 0; 
+  for(int row = 0; row <= height; row++)
+    {
+      //the row and its filter byte, split over the block boundaries
+      const unsigned char *data[2] = {&filter,rgb + 3*(size_t)width*row}; 
+      size_t size[2] = {1,3*(size_t)width}; 
+      for(int part = 0; part < 2 && row < height; part++)
+	{
+	  const unsigned char *p = data[part]; 
+	  size_t n = size[part]; 
+	  while(n > 0)
+	    {
+	      if(inblock == 0)
+		{
+		  size_t len = left < 65535 ? left : 65535; 
+		  unsigned char head[5] = {(unsigned char)(left <= 65535 ? 1 : 0),(unsigned char)(len & 0xff),(unsigned char)(len >> 8),
+					   (unsigned char)(~len & 0xff),(unsigned char)((~len >> 8) & 0xff)}; 
+		  chunk.put(head,5); 
+		  inblock = len; 
+		}
+	      size_t m = n < inblock ? n : inblock; 
+	      chunk.put(p,m); 
+	      adler = adler32(adler,p,m); 
+	      p += m; 
+	      n -= m; 
+	      inblock -= m; 
+	      left -= m; 
+	    }
+	}
+    }
+  if(raw == 0)
+    {
+      const unsigned char empty[5] = {1,0,0,0xff,0xff}; 
+      chunk.put(empty,5); 
+    }
+  unsigned char ztail[4]; 
+  putBE32(ztail,adler); 
+  chunk.put(ztail,4); 
+  chunk.end(); 
+
+  chunk.begin("IEND",0); 
+  chunk.end(); 
+  bool failed = ferror(out) != 0; 
+  outputClose(out); 
+  if(failed)
+    {
+      std::cerr << "Cannot write file: " << file << std::endl; 
+      return -1; 
+    }
+  return 0; 
+}//writePng()
+
+/*
+  renderRings, draws the rings colored by size to basename_poly.svg and
+  basename_poly.png without Mathematica
+  @param coords, unwrapped ring coordinates 
+  @param cell, periodic cell 
+  @param ringmin, ringmax range of ring sizes drawn 
+  @param width, width of the PNG in pixels 
+  @param tiles, tiles along each side of the PNG, 1 for a single file 
+  @param nthreads, largest number of threads of the PNG, as many as the 
+  thread budget gives if not positive
+  @param nfile, basename of the output files 
+*/
+void renderRings(RingCoords &coords, const Cell &cell, int ringmin, int ringmax, int width, int tiles, int nthreads, string nfile)
+{
+  RenderScene scene; 
+  buildRenderScene(coords,cell,ringmin,ringmax,width,scene); 
+  renderSvg(scene,nfile); 
+  renderPng(scene,tiles,nthreads,nfile); 
+  LOG(LOG_INFO) << "Rendered " << scene.size.size() << " ring polygons on " << scene.width << "x" << scene.height
+	    << " pixels" << std::endl; 
+}//renderRings()
@@ -0,0 +1,41 @@
+//render.h 
+#ifndef _RENDER_H
+#define _RENDER_H
+
+#include <vector>
+#include <string>
+
+#include "ringgeom.h"
+#include "cell.h"
+
+/*
+  Ring polygons in pixel coordinates, y down, ready to be rasterized.
+  The polygon of ring i has the vertices start[i] to start[i+1]-1 of x
+  and y. In a periodic cell the rings are drawn at the images that
+  reach into the cell, and each row of pixels is clipped to the cell
+  between clipleft and clipright.
+ */
+struct RenderScene
+{
+  int width; 
+  int height; 
+  float x0, y1;          //world coordinates of the top left corner
+  float scale;           //pixels per length
+  std::vector<float> x; 
+  std::vector<float> y; 
+  std::vector<int> start; 
+  std::vector<int> size;  //ring size of each polygon, for its color
+  std::vector<float> top, bottom, left, right; 
+  std::vector<float> clipleft; 
+  std::vector<float> clipright; 
+  float cell[4][2];      //corners of the periodic cell in pixels, for the SVG clip path
+  bool periodic; 
+}; 
+
+void buildRenderScene(RingCoords &coords, const Cell &cell, int ringmin, int ringmax, int width, RenderScene &scene); 
+void renderSvg(RenderScene &scene, string nfile="bilayer"); 
+void renderPng(RenderScene &scene, int tiles, int nthreads, string nfile="bilayer"); 
+int writePng(string file, int width, int height, const unsigned char *rgb); 
+void renderRings(RingCoords &coords, const Cell &cell, int ringmin, int ringmax, int width, int tiles, int nthreads, string nfile="bilayer"); 
+
+#endif
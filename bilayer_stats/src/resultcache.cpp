@@ -0,0 +1,120 @@
+//resultcache.cpp 
+#include <iostream>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "graphcache.h"
+#include "resultcache.h"
+
+/*
+  64 bit FNV-1a hash, built from 32 bit halves so it needs no 64 bit literals
+ */
+struct Fnv1a
+{
+  uint64_t hash; 
+  Fnv1a() : hash(((uint64_t)0xcbf29ce4 << 32) | 0x84222325) {} 
+  void add(const void *data, size_t n)
+  {
+    const uint64_t prime = ((uint64_t)0x100 << 32) | 0x1b3; 
+    const unsigned char *p = (const unsigned char*)data; 
+    for(size_t i = 0; i < n; i++)
+      {
+	hash ^= p[i]; 
+	hash *= prime; 
+      }
+  }
+  void addInt(int v) { add(&v,sizeof(v)); }
+  void addFloat(float v) { add(&v,sizeof(v)); }
+}; 
+
+/*
+  hashFile, adds the length and the bytes of a file to a hash 
+  @param file, name of the file 
+  @param fnv, the hash 
+  @return 0, -1 if the file cannot be read 
+*/
+int hashFile(const char *file, Fnv1a &fnv)
+{
+  FILE *in = fopen(file,"rb"); 
+  if(in == NULL)
+    return -1; 
+  std::vector<char> buffer(1 << 20); 
+  size_t n, total = 0; 
+  while((n = fread(&buffer[0],1,buffer.size(),in)) > 0)
+    {
+      fnv.add(&buffer[0],n); 
+      total += n; 
+    }
+  bool failed = ferror(in) != 0; 
+  fclose(in); 
+  //the length keeps the boundary between the files 
+  fnv.add(&total,sizeof(total)); 
+  return failed ? -1 : 0; 
+}//hashFile()
+
+/*
+  sampleKey, content address of the rings of a sample. The key covers
+  the coordinates and connectivity files, the parameters that change
+  the bonding or the rings, the edge edits, the version of the cache
+  and the version of the code it was built from, not the
+  parameters of the geometry, fits and outputs, so that changing those
+  reuses the cached rings. 
+  @param xyzfile, coordinates file 
+  @param confile, connectivity file, NULL for none 
+  @param par, parameters of the sample 
+  @return the key as 16 hex digits, empty if a file cannot be read 
+*/
+string sampleKey(const char *xyzfile, const char *confile, Parameters &par)
+{
+  Fnv1a fnv; 
+  fnv.addInt(RESULTCACHE_VERSION); 
+  fnv.addInt(GRAPHCACHE_VERSION); 
+  fnv.add(CODE_VERSION,sizeof(CODE_VERSION)); 
+  if(hashFile(xyzfile,fnv) != 0)
+    return ""; 
+  if(confile && hashFile(confile,fnv) != 0)
+    return ""; 
+  fnv.addInt(confile != NULL); 
+
+  fnv.addFloat(par.bondlength); 
+  fnv.addInt(par.autobond); 
+  fnv.addFloat(par.autobond ? par.pdfrange : 0.f); 
+  fnv.addInt(par.knnbond); 
+  fnv.addInt(par.knnbond ? par.bondneighbors : 0); 
+  fnv.addFloat(par.knnbond ? par.bondangle : 0.f); 
+  const Cell &c = par.cell; 
+  float cell[9] = {c.ax,c.ay,c.az,c.bx,c.by,c.bz,c.cx,c.cy,c.cz}; 
+  fnv.add(cell,sizeof(cell)); 
+  fnv.addInt(par.ringmax); 
+  fnv.addInt(par.layers); 
+  fnv.addInt(par.contract); 
+  fnv.addFloat(par.contract ? par.bridgecutoff : 0.f); 
+  fnv.addInt(par.edits.size()); 
+  for(unsigned int i = 0; i < par.edits.size(); i++)
+    {
+      fnv.addInt(par.edits[i].add); 
+      fnv.addInt(par.edits[i].i); 
+      fnv.addInt(par.edits[i].j); 
+    }
+
+  char key[17]; 
+  sprintf(key,"%08x%08x",(unsigned int)(fnv.hash >> 32),(unsigned int)(fnv.hash & 0xffffffffu)); 
+  return key; 
+}//sampleKey()
+
+/*
+  sampleCacheFile, basename of the cache of a key, creating the cache
+  directory if needed 
+  @param cachedir, directory of the cache 
+  @param key, key of the sample 
+  @return the basename, cachedir/key 
+*/
+string sampleCacheFile(const string &cachedir, const string &key)
+{
+  mkdir(cachedir.c_str(),0755); 
+  return cachedir + "/" + key; 
+}//sampleCacheFile()
@@ -0,0 +1,20 @@
+//resultcache.h 
+#ifndef _RESULTCACHE_H
+#define _RESULTCACHE_H
+
+#include <string>
+
+#include "sample.h"
+
+//bump when the bonding or the ring search gives different rings 
+#define RESULTCACHE_VERSION 2
+
+//version of the code, git describe of the build, see the Makefile 
+#ifndef CODE_VERSION
+#define CODE_VERSION "unknown"
+#endif
+
+string sampleKey(const char *xyzfile, const char *confile, Parameters &par); 
+string sampleCacheFile(const string &cachedir, const string &key); 
+
+#endif 
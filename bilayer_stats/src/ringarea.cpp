@@ -6,6 +6,11 @@
 
 #include "vertex.h"
 #include "ringarea.h"
+#include "ringkernel.h"
+#include "cell.h"
+#include "asyncwriter.h"
+#include "profile.h"
+#include "log.h"
 
 
 /*
@@ -17,375 +22,152 @@ void Hello()
 }//Hello
 
 
+/*
+  ringWalk, extends a path through the vertices of a ring, taking the
+  first edge to a vertex not yet visited and backing up from a dead
+  end, which a chord of the ring can lead to. A path through every
+  vertex whose last vertex is not bonded to the first is a dead end too. 
+  @param sorted, the path 
+  @param cycle, the vertices not yet visited 
+  @param n, vertices of the ring 
+  @return true once the path visits every vertex and closes 
+ */
+static bool ringWalk(std::vector<Vertex*> &sorted, std::vector<Vertex*> &cycle, unsigned int n)
+{
+  if(sorted.size() == n)
+    return sorted.back()->EdgeIndex(sorted[0]) >= 0; 
+  Vertex *last = sorted.back(); 
+  for(unsigned int i = 0; i < last->edges.size(); i++)
+    {
+      for(unsigned int j = 0; j < cycle.size(); j++)
+	{
+	  if(last->edges[i] != cycle[j])
+	    continue; 
+	  sorted.push_back(cycle[j]); 
+	  cycle.erase(cycle.begin()+j); 
+	  if(ringWalk(sorted,cycle,n))
+	    return true; 
+	  cycle.insert(cycle.begin()+j,sorted.back()); 
+	  sorted.pop_back(); 
+	  break; 
+	}
+    }
+  return false; 
+}//ringWalk()
+
 /*
   sortRing, sorts ring vertices in the order that they are connected
   @param, ring, n vector of Vertex*
   @return, sring, sorted ring
  */
-std::vector<Vertex*> ringSort(std::vector<Vertex*> &ring,bool Debug)
+std::vector<Vertex*> ringSort(std::vector<Vertex*> &ring)
 {
   std::vector<Vertex*> cycle = ring; 
   std::vector<Vertex*> sorted;
   unsigned int n = cycle.size(); 
 
-  if(Debug)
-    {
-      std::cout << "Pre-Sorted Ring Coordinates" << std::endl; 
-      for(unsigned int i = 0; i < cycle.size(); i++)
-	std::cout << cycle[i]->x << " " << cycle[i]->y << std::endl; 
-      
-      for(unsigned int i = 0; i < cycle[0]->edges.size(); i++)
-	{
-	  std::cout << cycle[0]->edges[i]->index << ": " << cycle[0]->edges[i]->x << " " << cycle[0]->edges[i]->y << std::endl; 
-	}
-
-    }//end Debug 
+  LOG(LOG_DEBUG) << "Pre-Sorted Ring Coordinates" << std::endl; 
+  for(unsigned int i = 0; i < cycle.size(); i++)
+    LOG(LOG_DEBUG) << cycle[i]->x << " " << cycle[i]->y << std::endl; 
+  for(unsigned int i = 0; i < cycle[0]->edges.size(); i++)
+    LOG(LOG_DEBUG) << cycle[0]->edges[i]->index << ": " << cycle[0]->edges[i]->x << " " << cycle[0]->edges[i]->y << std::endl; 
 
   sorted.push_back(cycle[0]); 
   cycle.erase(cycle.begin());
-  bool Match = false; 
-  while(sorted.size() != n)
-    {
-      for(unsigned int i = 0; i < sorted.back()->edges.size(); i++)
-	{
-	  Match = false; 
-	  for(unsigned int j = 0; j < cycle.size(); j++)
-	    {
-	      if(sorted.back()->edges[i] == cycle[j])
-		{
-		  if(Debug) std::cout << "Found a Match" << std::endl; 
-		  sorted.push_back(cycle[j]); 
-		  cycle.erase(cycle.begin()+j); 
-		  Match = true; 
-		  break; 
-		}//if 
-	    }
-	  if(Match)
-	    break; 
-	}//i loop 
-    }//while loop 
-
-
-  if (Debug)
+  if(!ringWalk(sorted,cycle,n))
     {
-      std::cout<< "Sorted List" << std::endl; 
-      for(unsigned int i = 0; i < sorted.size(); i++)
-	std::cout << sorted[i]->x << " " << sorted[i]->y << std::endl; 
+      LOG(LOG_WARN) << "Ring of " << n << " vertices from " << ring[0]->index << " is not a closed path, left unsorted" << std::endl; 
+      return ring; 
     }
 
+  LOG(LOG_DEBUG) << "Sorted List" << std::endl; 
+  for(unsigned int i = 0; i < sorted.size(); i++)
+    LOG(LOG_DEBUG) << sorted[i]->x << " " << sorted[i]->y << std::endl; 
+
   return sorted; 
 
 }//sortRing()
 
 /*
-  Given a sorted list output is the area
+  ringImage, periodic image of the edge from a vertex of a sorted ring
+  to the next vertex 
+  @param ring, sorted ring 
+  @param n, index of the vertex 
  */
-
-float calcarea(std::vector<Vertex*> &ring,bool Debug)
+Image ringImage(std::vector<Vertex*> &ring, unsigned int n)
 {
-  float area; 
-  unsigned int n = ring.size() + 1; 
-  float *x = new float [n];
-  float *y = new float [n]; 
-
-  
-  for(unsigned int i = 0; i < ring.size(); i++)
-    {
-      if (Debug) std::cout << "x= " << ring[i]->x << " y= " << ring[i]->y << std::endl; 
-      x[i] = ring[i]->x; 
-      y[i] = ring[i]->y;
-    }//i loop 
-  
-  x[n-1] = ring[0]->x; 
-  y[n-1] = ring[0]->y;
-  
-  //Calculate determinent for the area
-  
-  if(Debug)
-    {
-      std::cout << "Printing from array" << std::endl; 
-      for(unsigned int i = 0; i < n; i++)
-	std::cout << x[i] << " " << y[i] << std::endl; 
-    }
-  double a=0,b=0; 
-
-  for(unsigned int i = 0; i < n-1; i++)
-    {
-      a += x[i]*y[i+1];
-      b += y[i]*x[i+1]; 
-    }
-
-  area = (a-b)*0.5; 
-  
-  if(Debug) std::cout << "Area is " << area << std::endl; 
-
-  delete [] x; 
-  delete [] y; 
-
-  return abs(area); 
-  
-}//calcarea()
+  unsigned int m = (n == ring.size() - 1) ? 0 : n + 1; 
+  int k = ring[n]->EdgeIndex(ring[m]); 
+  if(k < 0)
+    return Image(); 
+  return ring[n]->images[k]; 
+}//ringImage()
 
 /*
-  PBCcheck for periodic boudary coundtions 
+  PBCcheck for periodic boudary coundtions, a ring wraps the box if
+  any of its edges bonds to a periodic image
  */
 bool PBCcheck(std::vector<Vertex*> &ring)
 {
   
-  unsigned int n = 0; 
-  unsigned int m = 0; 
-  float xdist = 0.0; 
-  float ydist = 0.0; 
-  float rdist = 0.0;  
-   
-  for(unsigned int i = 0; i < ring.size(); i++)
+  for(unsigned int n = 0; n < ring.size(); n++)
     {
-      n = i; 
-      if(n == (ring.size() - 1) )
-	m = 0;
-      else
-	m = n +1; 
-      xdist = ring[n]->x - ring[m]->x; 
-      ydist = ring[n]->y - ring[m]->y;
-      rdist = sqrt(xdist*xdist + ydist*ydist); 
-      if (rdist > 10)
+      if(ringImage(ring,n).wraps())
 	return true; 
-    }//j loop over vertices of ring i 
+    }//n loop over vertices of ring 
   
   return false; 
   
 }//PBCcheck 
 
 /*
-  ringArea, calculated the area of of convex polygon and return a
-  sorted ring list 
+  Checks if the rings are on the edges due to the periodic boundary
+  conditions and removes them. 
  */
-float ringArea(std::vector<Vertex*>  &ring_unsorted, float areaBucket[], float latticex, float latticey, bool Debug)
-{ 
- 
-  std::vector <Vertex*> ring = ringSort(ring_unsorted,Debug); 
-  float area = calcarea(ring); 
-  if(PBCcheck(ring))
-    {
-      std::cout << "Need to adjust the PBC conditions here" << std::endl; 
-      float xdist = 0.0; 
-      float ydist = 0.0; 
-      float a = latticex; 
-      float b = latticey; 
-      float *x = new float[ring.size()+1]; 
-      float *y = new float[ring.size()+1]; 
-      unsigned int n = 0; 
-      unsigned int m = 0; 
-      double left = 0.0; 
-      double right = 0.0; 
-
-      x[n] = ring[n]->x; 
-      y[n] = ring[n]->y;
-      while(n < ring.size() )
-	{
-	  if(n == ring.size() - 1 )
-	    m = 0; 
-	  else
-	    m = n + 1; 
-	  
-	  xdist = x[n] - ring[m]->x; 
-	  ydist = y[n] - ring[m]->y; 
-	  if(xdist > a/2)
-	    x[m] = ring[m]->x + a; 
-	  else if(xdist < -(a/2))
-	    x[m] = ring[m]->x - a;
-	  else
-	    x[m] = ring[m]->x; 
-	  if(ydist > b/2)
-	    y[m] = ring[m]->y + b; 
-	  else if(ydist < -(b/2))
-	    y[m] = ring[m]->y - b;
-	  else
-	    y[m] = ring[m]->y; 
-	  n++; 
-	}
-      x[ring.size()] = x[0]; 
-      y[ring.size()] = y[0]; 
-
-      for(unsigned int i = 0; i < ring.size(); i++)
-	{
-	  std::cout << "i: " << i << " ring[i]->x: " << ring[i]->x << " " << "ring[i]->y " << ring[i]->y << std::endl; 
-	  std::cout <<"i: " << i << " " << "x: " << x[i] << " " << "y: " << y[i] << std::endl; 
-	}
-
-      
-      //calculate area here 
-      for(unsigned int i = 0; i < ring.size(); i++)
-	{
-	  left += x[i]*y[i+1];
-	  right += y[i]*x[i+1]; 
-	}
-      
-      delete [] x; 
-      delete [] y; 
-      return abs(0.5*(left-right));
-      
-    }
-  areaBucket[ring.size()] += area; 
-  return area; 
-}
-
-
-/*
-  Calculates the average bond length of all the bonds. 
- */
-float avgbnd_length(Graph &bilayer,float latticex, float latticey)
-{
-  float bnd_length=0; 
-  int nbonds = 0; 
-  float xij,yij,zij,r;
-  FILE *out; 
-  out = fopen("bonlength.dat","w"); 
-  if(out == NULL)
-    {
-      std::cerr << "Cannot open file for write" << std::endl; 
-      exit(1); 
-    }
-
-  for(unsigned int i = 0; i < bilayer.vertices.size(); i++)
-    {
-      for(unsigned int j = 0; j < bilayer.vertices[i]->edges.size(); j++)
-	{
-	  xij = bilayer.vertices[i]->x - bilayer.vertices[i]->edges[j]->x;
-	  if(xij > (latticex/2))
-	    xij -= latticex; 
-	  if(xij < -(latticex/2))
-	    xij += latticex; 
-	  
-	  yij = bilayer.vertices[i]->y - bilayer.vertices[i]->edges[j]->y;
-	  if(yij > (latticey/2) )
-	    yij -= latticey; 
-	  if(yij < -(latticey/2))
-	    yij += latticey; 
-
-	  zij = bilayer.vertices[i]->z - bilayer.vertices[i]->edges[j]->z;
-	  r = sqrt( xij*xij + yij*yij + zij*zij );
-	  bnd_length += r; 
-	  nbonds += 1; 
-	  fprintf(out,"%f %d: %f %f %d: %f %f\n",r, bilayer.vertices[i]->index, bilayer.vertices[i]->x,bilayer.vertices[i]->y,bilayer.vertices[i]->edges[j]->index,
-		  bilayer.vertices[i]->edges[j]->x,bilayer.vertices[i]->edges[j]->y);
-	  
-	}//j loop over the edges of the ith vertex 
-    }//i loop over the vertices 
-  fclose(out); 
-
-  return bnd_length/((float)nbonds); 
-}//avgbnd_length 
-
-
-/*
-  Calculates the average bond length of all the bonds. 
- */
-float avgbnd_lengthtwo(Graph &bilayer,float latticex, float latticey)
-{
-  float bnd_length=0; 
-  int nbonds = 0; 
-  float xij,yij,zij,r;
-
-  for(unsigned int i = 0; i < bilayer.vertices.size(); i++)
-    {
-      for(unsigned int j = 0; j < bilayer.vertices[i]->edges.size(); j++)
-	{
-	  xij = bilayer.vertices[i]->x - bilayer.vertices[i]->edges[j]->x;
-	  if(xij > (latticex/2))
-	    xij -= latticex; 
-	  if(xij < -(latticex/2))
-	    xij += latticex; 
-	  
-	  yij = bilayer.vertices[i]->y - bilayer.vertices[i]->edges[j]->y;
-	  if(yij > (latticey/2) )
-	    yij -= latticey; 
-	  if(yij < -(latticey/2))
-	    yij += latticey; 
-
-	  zij = bilayer.vertices[i]->z - bilayer.vertices[i]->edges[j]->z;
-	  r = sqrt( xij*xij + yij*yij + zij*zij );
-	  bnd_length += r*r; 
-	  nbonds += 1; 
-	  
-	}//j loop over the edges of the ith vertex 
-    }//i loop over the vertices 
-
-  return bnd_length/((float)nbonds); 
-}//avgbnd_length 
-
-
-/*
-  Checks if the rings are on the edges due to the periodic boundary conditions.
-  TODO: Currently hardcodes for a dist of 10 as a PBC. Need to make variable. 
- */
-void PolygonPBC(std::vector<std::vector<Vertex*> > &sortedCycles, bool Debug)
+void PolygonPBC(std::vector<std::vector<Vertex*> > &sortedCycles)
 {
   
   //Do PBC for rings
-  unsigned int n = 0; 
-  unsigned int m = 0; 
-  float xdist = 0.0; 
-  float ydist = 0.0; 
-  float rdist = 0.0;  
-  bool tooBig = false; 
-
+  long removed = 0; 
   for(unsigned int i = 0; i < sortedCycles.size(); i++)
     {
-      tooBig = false; 
-      for(unsigned int j = 0; j < sortedCycles[i].size(); j++)
-	{
-	  n = j; 
-	  if(n == sortedCycles[i].size() - 1 )
-	    m = 0; 
-	  else
-	    m = n + 1; 
-	  xdist = sortedCycles[i][n]->x - sortedCycles[i][m]->x; 
-	  ydist = sortedCycles[i][n]->y - sortedCycles[i][m]->y; 
-	  rdist = sqrt(xdist*xdist + ydist*ydist); 
-	  if(Debug)
-	    std::cout << "rdist: " << rdist << std::endl; 
-	  if (rdist > 10)
-	    {
-	      if(Debug)
-		std::cout << "Too Big" << std::endl; 
-	      tooBig = true; 
-	      break; 
-	    }
-	}//j loop over vertices of ring i 
-      if(tooBig)
+      if(PBCcheck(sortedCycles[i]))
 	{
+	  LOG(LOG_DEBUG) << "Ring " << i << " wraps the box" << std::endl; 
 	  sortedCycles.erase(sortedCycles.begin()+i); 
 	  i--; 
+	  removed++; 
 	}
     }//i loop over rings 
+  profileCount(PROF_PBC_RINGS,removed); 
 
 }//PolygonPBC()
 
 
 /*
-  Calculates the average bond length of all the bonds. 
+  outputConnect, writes the connectivity of the graph to
+  basename_connectivity.dat, one line per vertex with its index followed
+  by the indices of its neighbors 
+  @param vertices, vertices of the graph 
+  @param nfile, basename of the output file 
  */
-void outputConnect(Graph &bilayer,float latticex, float latticey)
+void outputConnect(std::vector<Vertex*> &vertices, string nfile)
 {
-  float bnd_length=0; 
-  int nbonds = 0; 
-  float xij,yij,zij,r;
   FILE *out; 
-  out = fopen("connectivity.dat","w"); 
+  out = outputOpen(nfile+"_connectivity.dat"); 
   if(out == NULL)
     {
       std::cerr << "Cannot open file for write" << std::endl; 
-      exit(1); 
+      return; 
     }
 
-  for(unsigned int i = 0; i < bilayer.vertices.size(); i++)
+  for(unsigned int i = 0; i < vertices.size(); i++)
     {
-      fprintf(out,"%d ",bilayer.vertices[i]->index); 
-      for(unsigned int j = 0; j < bilayer.vertices[i]->edges.size(); j++)
-	fprintf(out,"%d ",bilayer.vertices[i]->edges[j]->index); 
+      fprintf(out,"%d ",vertices[i]->index); 
+      for(unsigned int j = 0; j < vertices[i]->edges.size(); j++)
+	fprintf(out,"%d ",vertices[i]->edges[j]->index); 
       fprintf(out,"\n"); 
     }//i loop over the vertices 
-  fclose(out); 
+  outputClose(out); 
   
 }//outputConnect 
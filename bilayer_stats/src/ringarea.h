@@ -3,13 +3,11 @@
 
 #include "vertex.h"
 #include "graph.h"
+#include "cell.h"
 
 void Hello(); 
-std::vector<Vertex*> ringSort(std::vector<Vertex*> &ring, bool Debug=false);
-float ringArea(std::vector<Vertex*>  &ring, float areaBucket[],float latticex, float latticey, bool Debug=false); 
-float calcarea(std::vector<Vertex*> &ring, bool Debug=false); 
-float avgbnd_length(Graph &bilayer,float latticex, float latticey);
-float avgbnd_lengthtwo(Graph &bilayer,float latticex, float latticey);
-void PolygonPBC(std::vector<std::vector<Vertex*> > &sortedCycles, bool Debug=false);
+std::vector<Vertex*> ringSort(std::vector<Vertex*> &ring);
+void PolygonPBC(std::vector<std::vector<Vertex*> > &sortedCycles);
 bool PBCcheck(std::vector<Vertex*> &ring); 
-void outputConnect(Graph &bilayer,float latticex, float latticey); 
+Image ringImage(std::vector<Vertex*> &ring, unsigned int n); 
+void outputConnect(std::vector<Vertex*> &vertices, string nfile="bilayer"); 
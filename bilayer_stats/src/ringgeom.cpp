@@ -0,0 +1,237 @@
+//ringgeom.cpp 
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#if defined(__x86_64__) || defined(__i386__)
+#define RINGGEOM_X86
+#include <immintrin.h>
+#endif
+
+#include "vertex.h"
+#include "ringarea.h"
+#include "ringgeom.h"
+#include "asyncwriter.h"
+
+/*
+  Rings of each size are padded to the widest vector, so that every
+  kernel below reads whole registers 
+*/
+const int RINGGEOM_PAD = 16; 
+
+/*
+  RingVec, the lanes of a vector register, one ring per lane. The
+  kernel of ringgeomlanes.h is written once against it and compiled for
+  each instruction set in a namespace of its own, ringGeometry picks the
+  widest one the processor runs. 
+*/
+namespace scalar
+{
+const int RINGGEOM_WIDTH = 1; 
+struct RingVec { float v; }; 
+inline RingVec ringVec(float v) { RingVec r; r.v = v; return r; }
+inline RingVec vload(const float *p) { return ringVec(*p); }
+inline void vstore(float *p, RingVec a) { *p = a.v; }
+inline RingVec vzero() { return ringVec(0.0f); }
+inline RingVec operator+(RingVec a, RingVec b) { return ringVec(a.v+b.v); }
+inline RingVec operator-(RingVec a, RingVec b) { return ringVec(a.v-b.v); }
+inline RingVec operator*(RingVec a, RingVec b) { return ringVec(a.v*b.v); }
+inline RingVec vsqrt(RingVec a) { return ringVec(std::sqrt(a.v)); }
+inline RingVec vpositive(RingVec a) { return ringVec(a.v > 0 ? 1.0f : 0.0f); }
+
+#include "ringgeomlanes.h"
+}
+
+#ifdef RINGGEOM_X86
+#pragma GCC push_options
+#pragma GCC target("avx2")
+namespace avx2
+{
+const int RINGGEOM_WIDTH = 8; 
+struct RingVec { __m256 v; }; 
+inline RingVec ringVec(__m256 v) { RingVec r; r.v = v; return r; }
+inline RingVec vload(const float *p) { return ringVec(_mm256_loadu_ps(p)); }
+inline void vstore(float *p, RingVec a) { _mm256_storeu_ps(p,a.v); }
+inline RingVec vzero() { return ringVec(_mm256_setzero_ps()); }
+inline RingVec operator+(RingVec a, RingVec b) { return ringVec(_mm256_add_ps(a.v,b.v)); }
+inline RingVec operator-(RingVec a, RingVec b) { return ringVec(_mm256_sub_ps(a.v,b.v)); }
+inline RingVec operator*(RingVec a, RingVec b) { return ringVec(_mm256_mul_ps(a.v,b.v)); }
+inline RingVec vsqrt(RingVec a) { return ringVec(_mm256_sqrt_ps(a.v)); }
+inline RingVec vpositive(RingVec a) 
+{
+  return ringVec(_mm256_and_ps(_mm256_cmp_ps(a.v,_mm256_setzero_ps(),_CMP_GT_OQ),_mm256_set1_ps(1.0f))); 
+}
+
+#include "ringgeomlanes.h"
+}
+#pragma GCC pop_options
+
+//without fused multiply adds, so the rings get the same geometry on every processor 
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#pragma GCC optimize("fp-contract=off")
+namespace avx512
+{
+const int RINGGEOM_WIDTH = 16; 
+struct RingVec { __m512 v; }; 
+inline RingVec ringVec(__m512 v) { RingVec r; r.v = v; return r; }
+inline RingVec vload(const float *p) { return ringVec(_mm512_loadu_ps(p)); }
+inline void vstore(float *p, RingVec a) { _mm512_storeu_ps(p,a.v); }
+inline RingVec vzero() { return ringVec(_mm512_setzero_ps()); }
+inline RingVec operator+(RingVec a, RingVec b) { return ringVec(_mm512_add_ps(a.v,b.v)); }
+inline RingVec operator-(RingVec a, RingVec b) { return ringVec(_mm512_sub_ps(a.v,b.v)); }
+inline RingVec operator*(RingVec a, RingVec b) { return ringVec(_mm512_mul_ps(a.v,b.v)); }
+inline RingVec vsqrt(RingVec a) { return ringVec(_mm512_maskz_sqrt_ps(0xFFFF,a.v)); }
+inline RingVec vpositive(RingVec a) 
+{
+  return ringVec(_mm512_maskz_mov_ps(_mm512_cmp_ps_mask(a.v,_mm512_setzero_ps(),_CMP_GT_OQ),_mm512_set1_ps(1.0f))); 
+}
+
+#include "ringgeomlanes.h"
+}
+#pragma GCC pop_options
+#endif
+
+/*
+  Kernel of the ring geometry, chosen once for the processor 
+ */
+typedef void (*RingGeometryKernel)(RingCoords &coords, RingGeometry &geometry); 
+
+static RingGeometryKernel ringGeometryKernel()
+{
+#ifdef RINGGEOM_X86
+  __builtin_cpu_init(); 
+  if(__builtin_cpu_supports("avx512f"))
+    return avx512::ringGeometryLanes; 
+  if(__builtin_cpu_supports("avx2"))
+    return avx2::ringGeometryLanes; 
+#endif
+  return scalar::ringGeometryLanes; 
+}//ringGeometryKernel()
+
+static const RingGeometryKernel ringGeometrySelected = ringGeometryKernel(); 
+
+/*
+  fillRingCoords, unwraps every ring with the periodic images of its
+  edges and lays out the coordinates by ring size 
+  @param sortedCycles, rings sorted in the order that they are connected
+  @param cell, periodic cell 
+  @param coords, filled with the coordinates 
+*/
+void fillRingCoords(std::vector<std::vector<Vertex*> > &sortedCycles, const Cell &cell, RingCoords &coords)
+{
+  unsigned int nsize = 0; 
+  for(unsigned int i = 0; i < sortedCycles.size(); i++)
+    if(sortedCycles[i].size() + 1 > nsize)
+      nsize = sortedCycles[i].size() + 1; 
+
+  coords.count.assign(nsize,0); 
+  coords.stride.assign(nsize,0); 
+  coords.offset.assign(nsize,0); 
+  coords.start.assign(nsize,0); 
+  for(unsigned int i = 0; i < sortedCycles.size(); i++)
+    coords.count[sortedCycles[i].size()]++; 
+
+  int nfloat = 0; 
+  int nring = 0; 
+  for(unsigned int n = 0; n < nsize; n++)
+    {
+      coords.stride[n] = (coords.count[n] + RINGGEOM_PAD - 1)/RINGGEOM_PAD*RINGGEOM_PAD; 
+      coords.offset[n] = nfloat; 
+      coords.start[n] = nring; 
+      nfloat += n*coords.stride[n]; 
+      nring += coords.count[n]; 
+    }
+  coords.x.assign(nfloat,0.0); 
+  coords.y.assign(nfloat,0.0); 
+  coords.z.assign(nfloat,0.0); 
+  coords.ring.assign(nring,0); 
+  coords.ox.assign(sortedCycles.size(),0.0); 
+  coords.oy.assign(sortedCycles.size(),0.0); 
+  coords.oz.assign(sortedCycles.size(),0.0); 
+  coords.wraps.assign(sortedCycles.size(),0); 
+
+  std::vector<int> filled(nsize,0); 
+  for(unsigned int i = 0; i < sortedCycles.size(); i++)
+    {
+      std::vector<Vertex*> &ring = sortedCycles[i]; 
+      unsigned int n = ring.size(); 
+      int r = filled[n]++; 
+      int s = coords.stride[n]; 
+      float *x = &coords.x[coords.offset[n] + r]; 
+      float *y = &coords.y[coords.offset[n] + r]; 
+      float *z = &coords.z[coords.offset[n] + r]; 
+      coords.ring[coords.start[n] + r] = i; 
+      coords.ox[i] = ring[0]->x; 
+      coords.oy[i] = ring[0]->y; 
+      coords.oz[i] = ring[0]->z; 
+
+      //walk the ring adding the bond to the image of each next vertex 
+      float xk = 0.0, yk = 0.0, zk = 0.0; 
+      for(unsigned int k = 0; k < n; k++)
+	{
+	  x[k*s] = xk; 
+	  y[k*s] = yk; 
+	  z[k*s] = zk; 
+	  if(k == n - 1)
+	    break; 
+	  Image image = ringImage(ring,k); 
+	  coords.wraps[i] |= image.wraps(); 
+	  float sx, sy, sz; 
+	  cellShift(cell,image,sx,sy,sz); 
+	  xk += ring[k+1]->x + sx - ring[k]->x; 
+	  yk += ring[k+1]->y + sy - ring[k]->y; 
+	  zk += ring[k+1]->z + sz - ring[k]->z; 
+	}
+      coords.wraps[i] |= ringImage(ring,n-1).wraps(); 
+    }
+}//fillRingCoords()
+
+/*
+  ringGeometry, area, perimeter, centroid, gyration, anisotropy,
+  convexity and vector area of every ring in one pass over the
+  coordinates. Rings of the same size are processed a vector register
+  at a time, AVX-512 or AVX2 when the processor has them. 
+  @param coords, ring coordinates from fillRingCoords 
+  @param geometry, filled for every ring of the ring list 
+*/
+void ringGeometry(RingCoords &coords, RingGeometry &geometry)
+{
+  unsigned int nring = coords.ox.size(); 
+  geometry.area.assign(nring,0.0); 
+  geometry.perimeter.assign(nring,0.0); 
+  geometry.cx.assign(nring,0.0); 
+  geometry.cy.assign(nring,0.0); 
+  geometry.cz.assign(nring,0.0); 
+  geometry.gyration.assign(nring,0.0); 
+  geometry.anisotropy.assign(nring,0.0); 
+  geometry.convexity.assign(nring,0.0); 
+  geometry.area3d.assign(nring,0.0); 
+
+  ringGeometrySelected(coords,geometry); 
+}//ringGeometry()
+
+/*
+  ringGeometryOut, one line of descriptors per ring in the order of
+  the ring list 
+  @param sortedCycles, ring list 
+  @param coords, ring coordinates 
+  @param geometry, descriptors from ringGeometry 
+  @param nfile, basename of the output file
+*/
+void ringGeometryOut(std::vector<std::vector<Vertex*> > &sortedCycles, RingCoords &coords, RingGeometry &geometry, string nfile)
+{
+  FILE *out; 
+  out = outputOpen(nfile+"_ringgeom.dat"); 
+  if(out == NULL)
+    {
+      std::cerr << "Cannot open file for write" << std::endl; 
+      return; 
+    }
+  fprintf(out,"#size area perimeter cx cy cz gyration anisotropy convexity area3d wraps\n"); 
+  for(unsigned int i = 0; i < sortedCycles.size(); i++)
+    fprintf(out,"%d %f %f %f %f %f %f %f %f %f %d\n",(int)sortedCycles[i].size(),geometry.area[i],
+	    geometry.perimeter[i],geometry.cx[i],geometry.cy[i],geometry.cz[i],geometry.gyration[i],
+	    geometry.anisotropy[i],geometry.convexity[i],geometry.area3d[i],(int)coords.wraps[i]); 
+  outputClose(out); 
+}//ringGeometryOut()
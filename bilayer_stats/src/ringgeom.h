@@ -0,0 +1,56 @@
+//ringgeom.h 
+#ifndef _RINGGEOM_H
+#define _RINGGEOM_H
+
+#include <vector>
+
+#include "vertex.h"
+#include "cell.h"
+
+/*
+  Coordinates of all rings unwrapped across the periodic box, laid out
+  by ring size. The rings of size n are stored as n rows of stride[n]
+  floats, row k holding vertex k of every ring of that size, so that
+  consecutive rings fill the lanes of a vector register. Coordinates
+  are relative to the first vertex of each ring, which is kept in
+  ox,oy,oz. 
+*/
+struct RingCoords
+{
+  std::vector<int> count;    //rings of each size 
+  std::vector<int> stride;   //count padded to the widest vector 
+  std::vector<int> offset;   //start of each size in x and y
+  std::vector<int> start;    //start of each size in ring 
+  std::vector<int> ring;     //index of the ring in the ring list 
+  std::vector<float> x; 
+  std::vector<float> y; 
+  std::vector<float> z; 
+  std::vector<float> ox;     //origin of each ring, indexed by the ring list 
+  std::vector<float> oy; 
+  std::vector<float> oz; 
+  std::vector<char> wraps;   //ring bonds across the periodic box 
+};
+
+/*
+  Geometry of each ring, indexed by the ring list. Area, perimeter,
+  centroid and shape are of the ring projected on the plane, area3d is
+  the magnitude of the vector area of the buckled ring. 
+ */
+struct RingGeometry
+{
+  std::vector<float> area; 
+  std::vector<float> perimeter; 
+  std::vector<float> cx;          //area centroid
+  std::vector<float> cy; 
+  std::vector<float> cz;          //mean height 
+  std::vector<float> gyration;    //radius of gyration of the vertices 
+  std::vector<float> anisotropy;  //(l1-l2)/(l1+l2) of the gyration tensor, 0 for a regular ring
+  std::vector<float> convexity;   //fraction of the vertices turning with the ring, 1 if convex
+  std::vector<float> area3d; 
+};
+
+void fillRingCoords(std::vector<std::vector<Vertex*> > &sortedCycles, const Cell &cell, RingCoords &coords); 
+void ringGeometry(RingCoords &coords, RingGeometry &geometry); 
+void ringGeometryOut(std::vector<std::vector<Vertex*> > &sortedCycles, RingCoords &coords, RingGeometry &geometry, string nfile="bilayer"); 
+
+#endif 
@@ -0,0 +1,89 @@
+//ringgeomlanes.h 
+//no include guard, ringgeom.cpp includes it once per instruction set 
+
+/*
+  ringGeometryLanes, the sums over the vertices of RINGGEOM_WIDTH rings
+  of the same size at a time, with the RingVec of the enclosing
+  namespace, and the geometry of each ring from its sums 
+  @param coords, ring coordinates from fillRingCoords 
+  @param geometry, sized for every ring of the ring list 
+*/
+static void ringGeometryLanes(RingCoords &coords, RingGeometry &geometry)
+{
+  //sums over the vertices of each lane 
+  enum { AREA, PERIM, CX, CY, SX, SY, SZ, SXX, SYY, SXY, SZZ, AX, AY, TURN, NSUM }; 
+  float sum[NSUM][RINGGEOM_WIDTH]; 
+  for(unsigned int n = 3; n < coords.count.size(); n++)
+    {
+      int s = coords.stride[n]; 
+      if(coords.count[n] == 0)
+	continue; 
+      const float *x = &coords.x[coords.offset[n]]; 
+      const float *y = &coords.y[coords.offset[n]]; 
+      const float *z = &coords.z[coords.offset[n]]; 
+      for(int r = 0; r < coords.count[n]; r += RINGGEOM_WIDTH)
+	{
+	  RingVec a = vzero(), p = vzero(), cx = vzero(), cy = vzero(); 
+	  RingVec sx = vzero(), sy = vzero(), sz = vzero(); 
+	  RingVec sxx = vzero(), syy = vzero(), sxy = vzero(), szz = vzero(); 
+	  RingVec ax = vzero(), ay = vzero(), turn = vzero(); 
+	  for(unsigned int k = 0; k < n; k++)
+	    {
+	      unsigned int j = (k+1 == n) ? 0 : k+1; 
+	      unsigned int l = (j+1 == n) ? 0 : j+1; 
+	      RingVec xk = vload(x + k*s + r), yk = vload(y + k*s + r), zk = vload(z + k*s + r); 
+	      RingVec xj = vload(x + j*s + r), yj = vload(y + j*s + r), zj = vload(z + j*s + r); 
+	      RingVec xl = vload(x + l*s + r), yl = vload(y + l*s + r); 
+	      RingVec cross = xk*yj - yk*xj; 
+	      RingVec dx = xj - xk, dy = yj - yk; 
+	      a = a + cross; 
+	      p = p + vsqrt(dx*dx + dy*dy); 
+	      cx = cx + (xk + xj)*cross; 
+	      cy = cy + (yk + yj)*cross; 
+	      sx = sx + xk; sy = sy + yk; sz = sz + zk; 
+	      sxx = sxx + xk*xk; syy = syy + yk*yk; sxy = sxy + xk*yk; szz = szz + zk*zk; 
+	      ax = ax + (yk*zj - zk*yj); 
+	      ay = ay + (zk*xj - xk*zj); 
+	      turn = turn + vpositive(dx*(yl - yj) - dy*(xl - xj)); 
+	    }
+	  vstore(sum[AREA],a); vstore(sum[PERIM],p); vstore(sum[CX],cx); vstore(sum[CY],cy); 
+	  vstore(sum[SX],sx); vstore(sum[SY],sy); vstore(sum[SZ],sz); 
+	  vstore(sum[SXX],sxx); vstore(sum[SYY],syy); vstore(sum[SXY],sxy); vstore(sum[SZZ],szz); 
+	  vstore(sum[AX],ax); vstore(sum[AY],ay); vstore(sum[TURN],turn); 
+
+	  for(int w = 0; w < RINGGEOM_WIDTH && r + w < coords.count[n]; w++)
+	    {
+	      int i = coords.ring[coords.start[n] + r + w]; 
+	      float twice = sum[AREA][w]; 
+	      geometry.area[i] = std::fabs(0.5*twice); 
+	      geometry.perimeter[i] = sum[PERIM][w]; 
+	      if(twice != 0)
+		{
+		  geometry.cx[i] = coords.ox[i] + sum[CX][w]/(3.0*twice); 
+		  geometry.cy[i] = coords.oy[i] + sum[CY][w]/(3.0*twice); 
+		}
+	      else
+		{
+		  geometry.cx[i] = coords.ox[i] + sum[SX][w]/n; 
+		  geometry.cy[i] = coords.oy[i] + sum[SY][w]/n; 
+		}
+	      geometry.cz[i] = coords.oz[i] + sum[SZ][w]/n; 
+
+	      double mx = sum[SX][w]/n, my = sum[SY][w]/n, mz = sum[SZ][w]/n; 
+	      double gxx = sum[SXX][w]/n - mx*mx; 
+	      double gyy = sum[SYY][w]/n - my*my; 
+	      double gxy = sum[SXY][w]/n - mx*my; 
+	      double gzz = sum[SZZ][w]/n - mz*mz; 
+	      double rg2 = gxx + gyy + gzz; 
+	      geometry.gyration[i] = rg2 > 0 ? std::sqrt(rg2) : 0.0; 
+	      double trace = gxx + gyy; 
+	      double split = std::sqrt((gxx - gyy)*(gxx - gyy) + 4.0*gxy*gxy); 
+	      geometry.anisotropy[i] = trace > 0 ? split/trace : 0.0; 
+
+	      int positive = (int)(sum[TURN][w] + 0.5); 
+	      geometry.convexity[i] = (twice > 0 ? positive : n - positive)/(float)n; 
+	      geometry.area3d[i] = 0.5*std::sqrt(sum[AX][w]*sum[AX][w] + sum[AY][w]*sum[AY][w] + twice*twice); 
+	    }
+	}//r loop over rings of size n 
+    }//n loop over ring sizes 
+}//ringGeometryLanes()
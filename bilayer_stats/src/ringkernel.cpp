@@ -0,0 +1,64 @@
+//ringkernel.cpp 
+#include <vector>
+#include <algorithm>
+
+#include "vertex.h"
+#include "ringkernel.h"
+
+/*
+  Calls the instantiation of KERNEL for the sizes RINGKERNEL_MIN to 
+  RINGKERNEL_MAX, the statement after the switch handles the rest. 
+*/
+#define RINGKERNEL_SWITCH(n, KERNEL, ARGS)	\
+  switch(n)					\
+    {						\
+    case 3: return KERNEL<3> ARGS;		\
+    case 4: return KERNEL<4> ARGS;		\
+    case 5: return KERNEL<5> ARGS;		\
+    case 6: return KERNEL<6> ARGS;		\
+    case 7: return KERNEL<7> ARGS;		\
+    case 8: return KERNEL<8> ARGS;		\
+    case 9: return KERNEL<9> ARGS;		\
+    case 10: return KERNEL<10> ARGS;		\
+    case 11: return KERNEL<11> ARGS;		\
+    case 12: return KERNEL<12> ARGS;		\
+    default: break;				\
+    }
+
+bool ringHasRepeat(std::vector<Vertex*> &cycle)
+{
+  if(cycle.empty())
+    return false; 
+  Vertex* const *c = &cycle[0]; 
+  RINGKERNEL_SWITCH(cycle.size(), hasRepeat, (c)); 
+  return hasRepeat(c,cycle.size()); 
+}//ringHasRepeat()
+
+int ringSharedVertices(std::vector<Vertex*> &small, std::vector<Vertex*> &big)
+{
+  Vertex* const *s = &small[0]; 
+  Vertex* const *b = &big[0]; 
+  RINGKERNEL_SWITCH(small.size(), sharedVertices, (s,b,big.size())); 
+  return sharedVertices(s,small.size(),b,big.size()); 
+}//ringSharedVertices()
+
+void ringCanonical(std::vector<Vertex*> &cycle)
+{
+  if(cycle.empty())
+    return; 
+  Vertex **c = &cycle[0]; 
+  RINGKERNEL_SWITCH(cycle.size(), canonicalCycle, (c)); 
+  std::sort(cycle.begin(), cycle.end()); 
+}//ringCanonical()
+
+bool ringSame(std::vector<Vertex*> &a, std::vector<Vertex*> &b)
+{
+  if(a.size() != b.size())
+    return false; 
+  if(a.empty())
+    return true; 
+  Vertex* const *pa = &a[0]; 
+  Vertex* const *pb = &b[0]; 
+  RINGKERNEL_SWITCH(a.size(), sameCycle, (pa,pb)); 
+  return sameCycle(pa,pb,a.size()); 
+}//ringSame()
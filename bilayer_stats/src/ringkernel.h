@@ -0,0 +1,106 @@
+//ringkernel.h 
+#ifndef _RINGKERNEL_H
+#define _RINGKERNEL_H
+
+#include <vector>
+#include <cmath>
+
+#include "vertex.h"
+
+/*
+  Kernels on a single ring. The sizes RINGKERNEL_MIN to RINGKERNEL_MAX
+  are instantiated with a fixed trip count so the loops are unrolled,
+  larger rings fall back to the loop over the runtime size. Raising
+  ringmax in the parameter file only adds rings to the fallback. 
+*/
+#define RINGKERNEL_MIN 3
+#define RINGKERNEL_MAX 12
+
+/*
+  Does a path visit a vertex more than once 
+ */
+template <unsigned int N>
+bool hasRepeat(Vertex* const *cycle)
+{
+  for(unsigned int j = 1; j < N; j++)
+    for(unsigned int k = 0; k < j; k++)
+      if(cycle[j] == cycle[k])
+	return true; 
+  return false; 
+}//hasRepeat()
+
+inline bool hasRepeat(Vertex* const *cycle, unsigned int n)
+{
+  for(unsigned int j = 1; j < n; j++)
+    for(unsigned int k = 0; k < j; k++)
+      if(cycle[j] == cycle[k])
+	return true; 
+  return false; 
+}//hasRepeat()
+
+/*
+  Number of vertices of a small ring that are in a larger ring
+ */
+template <unsigned int N>
+int sharedVertices(Vertex* const *small, Vertex* const *big, unsigned int nbig)
+{
+  int num_matches = 0; 
+  for(unsigned int n = 0; n < nbig; n++)
+    for(unsigned int m = 0; m < N; m++)
+      num_matches += (small[m] == big[n]); 
+  return num_matches; 
+}//sharedVertices()
+
+inline int sharedVertices(Vertex* const *small, unsigned int nsmall, Vertex* const *big, unsigned int nbig)
+{
+  int num_matches = 0; 
+  for(unsigned int n = 0; n < nbig; n++)
+    for(unsigned int m = 0; m < nsmall; m++)
+      num_matches += (small[m] == big[n]); 
+  return num_matches; 
+}//sharedVertices()
+
+/*
+  Canonical form of a cycle, its vertices in increasing address
+  order. Insertion sort is used for the fixed sizes. 
+ */
+template <unsigned int N>
+void canonicalCycle(Vertex **cycle)
+{
+  for(unsigned int i = 1; i < N; i++)
+    {
+      Vertex *v = cycle[i]; 
+      unsigned int j = i; 
+      for(; j > 0 && v < cycle[j-1]; j--)
+	cycle[j] = cycle[j-1]; 
+      cycle[j] = v; 
+    }
+}//canonicalCycle()
+
+/*
+  Compares two canonical cycles of the same size 
+ */
+template <unsigned int N>
+bool sameCycle(Vertex* const *a, Vertex* const *b)
+{
+  for(unsigned int i = 0; i < N; i++)
+    if(a[i] != b[i])
+      return false; 
+  return true; 
+}//sameCycle()
+
+inline bool sameCycle(Vertex* const *a, Vertex* const *b, unsigned int n)
+{
+  for(unsigned int i = 0; i < n; i++)
+    if(a[i] != b[i])
+      return false; 
+  return true; 
+}//sameCycle()
+
+//Dispatch on the runtime size of the ring 
+bool ringHasRepeat(std::vector<Vertex*> &cycle); 
+int ringSharedVertices(std::vector<Vertex*> &small, std::vector<Vertex*> &big); 
+void ringCanonical(std::vector<Vertex*> &cycle); 
+bool ringSame(std::vector<Vertex*> &a, std::vector<Vertex*> &b); 
+
+#endif 
@@ -0,0 +1,67 @@
+//sample.h 
+#ifndef _SAMPLE_H
+#define _SAMPLE_H
+
+#include <string>
+
+#include "cell.h"
+#include "stages.h"
+#include "edits.h"
+
+using namespace std; 
+
+/*
+  Parameters read from the xml parameter file of a sample
+ */
+struct Parameters
+{
+  float bondlength; 
+  bool autobond;     //bondlength from the first minimum of the pair distances 
+  float pdfrange;    //largest pair distance of the histogram with autobond 
+  bool knnbond;      //bond each silicon to its nearest neighbors instead of by bondlength 
+  int bondneighbors; //nearest neighbors of each silicon with knnbond 
+  float bondangle;   //smallest angle between two bonds with knnbond, in degrees 
+  string basename; 
+  Cell cell;         //periodic cell, not periodic without pbc 
+  int ringmin; 
+  int ringmax; 
+  bool bonddump; 
+  bool npy;          //arrays of the rings, Aboav stack and bonds as .npy files 
+  int bootstrap;     //resamples of the fit intervals 
+  bool layers;       //analyze the two sheets of a bilayer apart 
+  bool contract;     //contract Si-O-Si bridges into Si-Si edges 
+  float bridgecutoff; 
+  bool cache;        //write the graph and rings to basename.bgc 
+  string cachedir;   //content addressed cache of the graph and rings, empty for none 
+  int render;        //width of basename_poly.png in pixels, 0 for no rendering 
+  int rendertiles;   //tiles along each side of the rendered picture 
+  unsigned int outputs;  //requested output files, bits of Output 
+  unsigned int stages;   //stages the outputs need, bits of Stage 
+  std::vector<EdgeEdit> edits;  //edges to add or remove before the ring search 
+};
+
+/*
+  Statistics of a single sample, one row of the batch summary 
+ */
+struct SampleSummary
+{
+  string basename; 
+  string error; 
+  int status; 
+  int natoms; 
+  int nbonds; 
+  int nrings; 
+  double average; 
+  double mu2; 
+  double bndlength; 
+  double deviation; 
+  double arealength; 
+  double lewis; 
+  double alpha; 
+  SampleSummary() : status(-1), natoms(0), nbonds(0), nrings(0), average(0), mu2(0), 
+    bndlength(0), deviation(0), arealength(0), lewis(0), alpha(0) {}
+};
+
+int analyzeSample(const char *xyzfile, const char *xmlfile, const char *confile, SampleSummary &summary); 
+
+#endif 
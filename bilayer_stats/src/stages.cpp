@@ -0,0 +1,121 @@
+//stages.cpp
+#include <iostream>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "stages.h"
+
+using namespace std;
+
+/*
+  Name of each output in the outputs parameter, the suffix of its file
+ */
+static const char *outputNames[NOUTPUTS] = {
+  "structure", "SiO", "connectivity", "ringCount", "cycleList", "ringgeom", "ringdist", "poly",
+  "bondhist", "ringhist", "areahist", "ringlist", "oringlist", "aboavDiagnostic", "AboavStack",
+  "ABOAV", "fits", "registration", "edits", "pdf"
+};
+
+/*
+  Stages each output needs, before the closure over the stage dependencies
+ */
+static const unsigned int outputNeeds[NOUTPUTS] = {
+  0,                                          //structure
+  0,                                          //SiO
+  0,                                          //connectivity
+  1u << STAGE_RINGS,                          //ringCount
+  1u << STAGE_RINGS,                          //cycleList
+  1u << STAGE_GEOMETRY,                       //ringgeom
+  1u << STAGE_GEOMETRY,                       //ringdist
+  1u << STAGE_FILTER,                         //poly
+  1u << STAGE_BONDS,                          //bondhist
+  1u << STAGE_RINGS,                          //ringhist
+  (1u << STAGE_GEOMETRY) | (1u << STAGE_BONDS), //areahist
+  1u << STAGE_FILTER,                         //ringlist
+  1u << STAGE_FILTER,                         //oringlist
+  1u << STAGE_ABOAV,                          //aboavDiagnostic
+  1u << STAGE_ABOAV,                          //AboavStack
+  1u << STAGE_ABOAV,                          //ABOAV
+  1u << STAGE_FITS,                           //fits
+  0,                                          //registration
+  0,                                          //edits
+  0                                           //pdf
+};
+
+/*
+  Stages each stage needs to have run before it
+ */
+static const unsigned int stageNeeds[NSTAGES] = {
+  0,                                                              //rings
+  1u << STAGE_RINGS,                                              //sort
+  1u << STAGE_SORT,                                               //geometry
+  (1u << STAGE_SORT) | (1u << STAGE_GEOMETRY),                    //filter
+  0,                                                              //bonds
+  1u << STAGE_RINGS,                                              //aboav
+  (1u << STAGE_GEOMETRY) | (1u << STAGE_ABOAV) | (1u << STAGE_BONDS) //fits
+};
+
+/*
+  parseOutputs, reads a list of output names separated by spaces or
+  commas, "all" for every output
+  @param text, list of names
+  @param outputs, set to the bits of the outputs
+  @return 0, -1 if a name is not an output
+*/
+int parseOutputs(const char *text, unsigned int &outputs)
+{
+  string list = text;
+  for(unsigned int i = 0; i < list.size(); i++)
+    if(list[i] == ',')
+      list[i] = ' ';
+  std::istringstream in(list);
+  string name;
+  outputs = 0;
+  while(in >> name)
+    {
+      if(name == "all")
+	{
+	  outputs = ALL_OUTPUTS;
+	  continue;
+	}
+      int i = 0;
+      while(i < NOUTPUTS && name != outputNames[i])
+	i++;
+      if(i == NOUTPUTS)
+	{
+	  std::cerr << "Unknown output: " << name << std::endl;
+	  return -1;
+	}
+      outputs |= 1u << i;
+    }
+  return 0;
+}//parseOutputs()
+
+/*
+  stageClosure, adds to a set of stages every stage they depend on
+  @param stages, bits of the stages
+  @return the stages and their dependencies
+*/
+unsigned int stageClosure(unsigned int stages)
+{
+  //a stage only depends on earlier stages, one pass from the last is enough
+  for(int s = NSTAGES - 1; s >= 0; s--)
+    if(hasStage(stages,(Stage)s))
+      stages |= stageNeeds[s];
+  return stages;
+}//stageClosure()
+
+/*
+  outputStages, the stages that have to run for a set of outputs
+  @param outputs, bits of the outputs
+  @return bits of the stages
+*/
+unsigned int outputStages(unsigned int outputs)
+{
+  unsigned int stages = 0;
+  for(int i = 0; i < NOUTPUTS; i++)
+    if(hasOutput(outputs,(Output)i))
+      stages |= outputNeeds[i];
+  return stageClosure(stages);
+}//outputStages()
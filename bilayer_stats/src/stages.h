@@ -0,0 +1,63 @@
+//stages.h 
+#ifndef _STAGES_H
+#define _STAGES_H
+
+/*
+  Output files of a sample, by the suffix of their name. Their bits
+  make the requested output set of a run. 
+ */
+enum Output
+{
+  OUT_STRUCTURE,        //_structure.m 
+  OUT_SIO,              //_SiO.con 
+  OUT_CONNECTIVITY,     //_connectivity.dat 
+  OUT_RINGCOUNT,        //_ringCount.dat 
+  OUT_CYCLELIST,        //_cycleList.dat 
+  OUT_RINGGEOM,         //_ringgeom.dat 
+  OUT_RINGDIST,         //_ringdist.dat 
+  OUT_POLY,             //_poly.m 
+  OUT_BONDHIST,         //_bondhist.dat 
+  OUT_RINGHIST,         //_ringhist.dat 
+  OUT_AREAHIST,         //_areahist.dat 
+  OUT_RINGLIST,         //_ringlist.dat 
+  OUT_ORINGLIST,        //_oringlist.dat 
+  OUT_ABOAVDIAGNOSTIC,  //_aboavDiagnostic.dat 
+  OUT_ABOAVSTACK,       //_AboavStack.dat 
+  OUT_ABOAV,            //_ABOAV.dat 
+  OUT_FITS,             //_fits.dat 
+  OUT_REGISTRATION,     //_registration.dat 
+  OUT_EDITS,            //_edits.dat 
+  OUT_PDF,              //_pdf.dat 
+  NOUTPUTS
+};
+
+/*
+  Stages of the analysis after the graph is bonded, in the order they
+  run. Each stage runs only if a requested output needs it. 
+ */
+enum Stage
+{
+  STAGE_RINGS,          //ring search and ring counts 
+  STAGE_SORT,           //vertices of each ring in ring order 
+  STAGE_GEOMETRY,       //unwrapped coordinates, areas and shapes 
+  STAGE_FILTER,         //rings across the periodic box dropped from the sorted list 
+  STAGE_BONDS,          //bond length statistics 
+  STAGE_ABOAV,          //neighboring rings of each ring 
+  STAGE_FITS,           //Lewis, Aboav-Weaire and area law fits 
+  NSTAGES
+};
+
+const unsigned int ALL_OUTPUTS = (1u << NOUTPUTS) - 1; 
+
+//outputs of a run without an outputs parameter, the proposed edits are
+//only searched when asked for 
+const unsigned int DEFAULT_OUTPUTS = ALL_OUTPUTS & ~(1u << OUT_EDITS); 
+
+inline bool hasOutput(unsigned int outputs, Output output) { return (outputs >> output) & 1; }
+inline bool hasStage(unsigned int stages, Stage stage) { return (stages >> stage) & 1; }
+
+int parseOutputs(const char *text, unsigned int &outputs); 
+unsigned int stageClosure(unsigned int stages); 
+unsigned int outputStages(unsigned int outputs); 
+
+#endif 
@@ -1,11 +1,494 @@
 //testcases.cpp 
 #include <vector>
 #include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <dirent.h>
+#include <unistd.h>
 
 #include "testcases.h"
 #include "vertex.h"
+#include "sample.h"
+#include "batch.h"
+#include "asyncwriter.h"
+#include "outbuffer.h"
+#include "graphcache.h"
+#include "fitting.h"
 
 void testSquare()
 {
   std::cout << "Hello from testsquare" << std::endl; 
 }
+
+/*
+  testDirectory, makes an empty directory for the files of a test
+  @return path of the directory, empty if it cannot be made 
+*/
+static string testDirectory()
+{
+  char dir[] = "/tmp/bilayer_testXXXXXX"; 
+  if(mkdtemp(dir) == NULL)
+    return ""; 
+  return dir; 
+}//testDirectory()
+
+/*
+  removeDirectory, removes a test directory and the files in it
+*/
+static void removeDirectory(string dir)
+{
+  DIR *d = opendir(dir.c_str()); 
+  if(d == NULL)
+    return; 
+  struct dirent *entry; 
+  while((entry = readdir(d)) != NULL)
+    {
+      string name = entry->d_name; 
+      if(name != "." && name != "..")
+	unlink((dir + "/" + name).c_str()); 
+    }
+  closedir(d); 
+  rmdir(dir.c_str()); 
+}//removeDirectory()
+
+/*
+  sampleFiles, writes the xyz and xml files of a two dimensional sample
+  of silicons, bonded by distance in a periodic box
+  @param x, y coordinates of the silicons 
+  @param extra, further parameters of the xml file 
+*/
+static int sampleFiles(string dir, string name, std::vector<double> &x, std::vector<double> &y, double lx, double ly, double bondlength, string extra = "")
+{
+  FILE *out = fopen((dir + "/" + name + ".xyz").c_str(),"w"); 
+  if(out == NULL)
+    return -1; 
+  fprintf(out,"%d\n%s\n",(int)x.size(),name.c_str()); 
+  for(unsigned int i = 0; i < x.size(); i++)
+    fprintf(out,"Si %f %f 0.0\n",x[i],y[i]); 
+  fclose(out); 
+
+  out = fopen((dir + "/" + name + ".xml").c_str(),"w"); 
+  if(out == NULL)
+    return -1; 
+  fprintf(out,"<root>\n<distbond>1</distbond>\n<bondlength>%f</bondlength>\n",bondlength); 
+  fprintf(out,"<basename>%s/%s</basename>\n",dir.c_str(),name.c_str()); 
+  fprintf(out,"<pbc>1</pbc>\n<latticex>%f</latticex>\n<latticey>%f</latticey>\n",lx,ly); 
+  fprintf(out,"%s</root>\n",extra.c_str()); 
+  fclose(out); 
+  return 0; 
+}//sampleFiles()
+
+/*
+  testRinglessBatch, a batch with a sample of isolated silicons, which
+  has no rings, next to a honeycomb. Both samples must be analyzed and
+  the summary written.
+  @return number of failed checks 
+*/
+int testRinglessBatch()
+{
+  string dir = testDirectory(); 
+  if(dir.empty())
+    {
+      std::cerr << "testRinglessBatch: cannot make a test directory" << std::endl; 
+      return 1; 
+    }
+
+  //three silicons further apart than the bond length
+  std::vector<double> x, y; 
+  x.push_back(1.0); y.push_back(1.0); 
+  x.push_back(5.0); y.push_back(5.0); 
+  x.push_back(9.0); y.push_back(1.0); 
+  int status = sampleFiles(dir,"ringless",x,y,12.0,12.0,2.0); 
+
+  //honeycomb of 6 x 4 rectangular cells of 4 silicons, 48 hexagons
+  const double d = 3.0; 
+  const double w = sqrt(3.0)*d; 
+  const int nx = 6, ny = 4; 
+  x.clear(); 
+  y.clear(); 
+  for(int i = 0; i < nx; i++)
+    for(int j = 0; j < ny; j++)
+      {
+	x.push_back(i*w);         y.push_back(j*3*d); 
+	x.push_back(i*w + w/2);   y.push_back(j*3*d + d/2); 
+	x.push_back(i*w + w/2);   y.push_back(j*3*d + 3*d/2); 
+	x.push_back(i*w);         y.push_back(j*3*d + 2*d); 
+      }
+  status |= sampleFiles(dir,"honeycomb",x,y,nx*w,ny*3*d,1.2*d); 
+
+  FILE *out = fopen((dir + "/batch.txt").c_str(),"w"); 
+  if(status != 0 || out == NULL)
+    {
+      std::cerr << "testRinglessBatch: cannot write the samples" << std::endl; 
+      removeDirectory(dir); 
+      return 1; 
+    }
+  fprintf(out,"%s/ringless.xyz %s/ringless.xml\n",dir.c_str(),dir.c_str()); 
+  fprintf(out,"%s/honeycomb.xyz %s/honeycomb.xml\n",dir.c_str(),dir.c_str()); 
+  fclose(out); 
+
+  int nfailed = 0; 
+  if(runBatch((dir + "/batch.txt").c_str(),2) != 0)
+    {
+      std::cerr << "testRinglessBatch: batch failed" << std::endl; 
+      nfailed++; 
+    }
+  outputFlush(); 
+
+  //the summary lists both samples with their atoms and rings
+  FILE *in = fopen((dir + "/batch_summary.dat").c_str(),"r"); 
+  if(in == NULL)
+    {
+      std::cerr << "testRinglessBatch: no summary written" << std::endl; 
+      removeDirectory(dir); 
+      return nfailed + 1; 
+    }
+  char line[1024], xyz[512], basename[512], state[16]; 
+  int natoms, nbonds, nrings, nsamples = 0; 
+  while(fgets(line,sizeof(line),in))
+    {
+      if(line[0] == '#')
+	continue; 
+      if(sscanf(line,"%511s %511s %15s %d %d %d",xyz,basename,state,&natoms,&nbonds,&nrings) != 6)
+	continue; 
+      nsamples++; 
+      bool ringless = strstr(xyz,"ringless") != NULL; 
+      if(strcmp(state,"OK") != 0 || natoms != (ringless ? 3 : 4*nx*ny) || nrings != (ringless ? 0 : 2*nx*ny) || strstr(line,"nan"))
+	{
+	  std::cerr << "testRinglessBatch: wrong summary line " << line; 
+	  nfailed++; 
+	}
+    }
+  fclose(in); 
+  if(nsamples != 2)
+    {
+      std::cerr << "testRinglessBatch: " << nsamples << " samples in the summary instead of 2" << std::endl; 
+      nfailed++; 
+    }
+
+  //the ring counts of the ringless sample have no NaN average 
+  in = fopen((dir + "/ringless_ringCount.dat").c_str(),"r"); 
+  bool nan = in == NULL; 
+  while(in && fgets(line,sizeof(line),in))
+    if(strstr(line,"nan"))
+      nan = true; 
+  if(in)
+    fclose(in); 
+  if(nan)
+    {
+      std::cerr << "testRinglessBatch: no ring counts or a NaN in them" << std::endl; 
+      nfailed++; 
+    }
+
+  //rings of one size do not determine the Aboav-Weaire line 
+  in = fopen((dir + "/honeycomb_fits.dat").c_str(),"r"); 
+  bool nofit = false; 
+  while(in && fgets(line,sizeof(line),in))
+    if(strncmp(line,"aboav no fit",12) == 0)
+      nofit = true; 
+  if(in)
+    fclose(in); 
+  if(!nofit)
+    {
+      std::cerr << "testRinglessBatch: the honeycomb has an Aboav-Weaire fit" << std::endl; 
+      nfailed++; 
+    }
+  removeDirectory(dir); 
+  return nfailed; 
+}//testRinglessBatch()
+
+/*
+  testRingmax, a single ring of 12 silicons is found with ringmax 12 and
+  not with ringmax 11 
+  @return number of failed checks 
+*/
+int testRingmax()
+{
+  string dir = testDirectory(); 
+  if(dir.empty())
+    {
+      std::cerr << "testRingmax: cannot make a test directory" << std::endl; 
+      return 1; 
+    }
+  const double PI = 3.14159265358979; 
+  const double d = 3.0; 
+  const double r = d/(2*sin(PI/12)); 
+  std::vector<double> x, y; 
+  for(int i = 0; i < 12; i++)
+    {
+      x.push_back(15 + r*cos(2*PI*i/12)); 
+      y.push_back(15 + r*sin(2*PI*i/12)); 
+    }
+  int nfailed = 0; 
+  for(int ringmax = 11; ringmax <= 12; ringmax++)
+    {
+      char name[32], extra[64]; 
+      sprintf(name,"ring%d",ringmax); 
+      sprintf(extra,"<ringmax>%d</ringmax>\n<outputs>ringCount</outputs>\n",ringmax); 
+      SampleSummary summary; 
+      if(sampleFiles(dir,name,x,y,30.0,30.0,1.2*d,extra) != 0 || 
+	 analyzeSample((dir + "/" + name + ".xyz").c_str(),(dir + "/" + name + ".xml").c_str(),NULL,summary) != 0)
+	{
+	  std::cerr << "testRingmax: cannot analyze " << name << std::endl; 
+	  nfailed++; 
+	  continue; 
+	}
+      if(summary.nrings != (ringmax == 12 ? 1 : 0))
+	{
+	  std::cerr << "testRingmax: " << summary.nrings << " rings with ringmax " << ringmax << std::endl; 
+	  nfailed++; 
+	}
+    }
+  outputFlush(); 
+  removeDirectory(dir); 
+  return nfailed; 
+}//testRingmax()
+
+/*
+  testPutFloat, OutBuffer::putFloat writes the same text as printf %f,
+  for values at the rounding edges and for floats of random bits 
+  @return number of failed checks 
+*/
+int testPutFloat()
+{
+  std::vector<float> values; 
+  const float edges[] = {0.0f, -0.0f, 1.0f, -1.0f, 0.5f, 0.0000005f, 0.0000015f, 0.0000025f, 
+			 0.1f, 0.3f, 2.5f, 123.456789f, -0.0000004f, 4294.967f, 4295.0f, 1e10f, 
+			 -1e10f, 3.4e38f}; 
+  for(unsigned int i = 0; i < sizeof(edges)/sizeof(edges[0]); i++)
+    values.push_back(edges[i]); 
+  srand(12345); 
+  for(int i = 0; i < 200000; i++)
+    {
+      //random mantissa and sign, exponents of 1e-8 to 1e5 
+      unsigned int bits = ((unsigned int)rand() << 16 ^ (unsigned int)rand()) & 0x807fffffu; 
+      bits |= (unsigned int)(100 + rand() % 44) << 23; 
+      float f; 
+      memcpy(&f,&bits,sizeof(f)); 
+      values.push_back(f); 
+    }
+
+  FILE *out = tmpfile(); 
+  if(out == NULL)
+    {
+      std::cerr << "testPutFloat: cannot open a temporary file" << std::endl; 
+      return 1; 
+    }
+  OutBuffer buffer(out,4096); 
+  for(unsigned int i = 0; i < values.size(); i++)
+    {
+      buffer.putFloat(values[i]); 
+      buffer.put('\n'); 
+    }
+  buffer.flush(); 
+  rewind(out); 
+
+  int nfailed = 0; 
+  char line[128], expected[128]; 
+  for(unsigned int i = 0; i < values.size(); i++)
+    {
+      sprintf(expected,"%f\n",values[i]); 
+      if(fgets(line,sizeof(line),out) == NULL || strcmp(line,expected) != 0)
+	{
+	  if(nfailed < 10)
+	    std::cerr << "testPutFloat: " << expected << " written as " << line << std::endl; 
+	  nfailed++; 
+	}
+    }
+  fclose(out); 
+  return nfailed; 
+}//testPutFloat()
+
+/*
+  testGraphCache, a graph with a periodic edge, a bridged edge and a ring
+  is written to a .bgc file and read back unchanged 
+  @return number of failed checks 
+*/
+int testGraphCache()
+{
+  string dir = testDirectory(); 
+  if(dir.empty())
+    {
+      std::cerr << "testGraphCache: cannot make a test directory" << std::endl; 
+      return 1; 
+    }
+
+  //a triangle of silicons, the edge 0-2 across the cell and 1-2 bridged by an oxygen 
+  Graph graph; 
+  for(int i = 0; i < 3; i++)
+    {
+      Vertex *v = new Vertex(14,1.5f*i,0.25f + i,0.1f*i); 
+      v->index = 10 + i; 
+      v->layer = i % 2; 
+      graph.vertices.push_back(v); 
+    }
+  Vertex *o = new Vertex(8,2.25f,1.75f,0.05f); 
+  o->index = 20; 
+  graph.bridges.push_back(o); 
+  Vertex **v = &graph.vertices[0]; 
+  v[0]->AddEdge(v[1],Image(0,0)); 
+  v[1]->AddEdge(v[0],Image(0,0)); 
+  v[0]->AddEdge(v[2],Image(-1,0)); 
+  v[2]->AddEdge(v[0],Image(1,0)); 
+  v[1]->AddEdge(v[2],Image(0,0),o); 
+  v[2]->AddEdge(v[1],Image(0,0),o); 
+  std::vector<std::vector<Vertex*> > rings(1,graph.vertices); 
+  Cell cell(12.0f,0.0f,1.5f,10.0f); 
+  SampleSummary summary; 
+  summary.natoms = 3; 
+  summary.nbonds = 3; 
+  summary.nrings = 1; 
+  summary.average = 3.0; 
+  summary.mu2 = 0.25; 
+  summary.bndlength = 1.75; 
+  summary.lewis = 0.5; 
+
+  int nfailed = 0; 
+  string base = dir + "/sample"; 
+  Graph read; 
+  Cell readcell; 
+  std::vector<std::vector<Vertex*> > readrings; 
+  SampleSummary readsummary; 
+  int status = writeGraphCache(graph,cell,rings,summary,base); 
+  outputFlush(); 
+  if(status != 0 || !isGraphCache((base + ".bgc").c_str()) || 
+     readGraphCache((base + ".bgc").c_str(),read,readcell,readrings,readsummary) != 0)
+    {
+      std::cerr << "testGraphCache: cannot write and read " << base << ".bgc" << std::endl; 
+      removeDirectory(dir); 
+      return 1; 
+    }
+
+  if(read.vertices.size() != 3 || read.bridges.size() != 1 || readrings.size() != 1 || readrings[0].size() != 3)
+    {
+      std::cerr << "testGraphCache: " << read.vertices.size() << " vertices, " << read.bridges.size() << " bridges and " 
+		<< readrings.size() << " rings read back" << std::endl; 
+      removeDirectory(dir); 
+      return 1; 
+    }
+  for(unsigned int i = 0; i < 3; i++)
+    {
+      Vertex *a = graph.vertices[i]; 
+      Vertex *b = read.vertices[i]; 
+      bool same = a->x == b->x && a->y == b->y && a->z == b->z && a->index == b->index && a->atomno == b->atomno 
+	&& a->layer == b->layer && a->edges.size() == b->edges.size(); 
+      for(unsigned int e = 0; same && e < a->edges.size(); e++)
+	{
+	  int bridge = a->bridges[e] ? 0 : -1; 
+	  same = b->edges[e] == read.vertices[a->edges[e]->index - 10] && b->images[e].nx == a->images[e].nx 
+	    && b->images[e].ny == a->images[e].ny && b->images[e].nz == a->images[e].nz 
+	    && b->bridges[e] == (bridge < 0 ? NULL : read.bridges[bridge]); 
+	}
+      if(!same || readrings[0][i] != read.vertices[i])
+	{
+	  std::cerr << "testGraphCache: vertex " << i << " read back differently" << std::endl; 
+	  nfailed++; 
+	}
+    }
+  Vertex *b = read.bridges[0]; 
+  if(b->x != o->x || b->y != o->y || b->z != o->z || b->index != o->index || b->atomno != o->atomno)
+    {
+      std::cerr << "testGraphCache: bridge read back differently" << std::endl; 
+      nfailed++; 
+    }
+  if(readcell.ax != cell.ax || readcell.ay != cell.ay || readcell.bx != cell.bx || readcell.by != cell.by)
+    {
+      std::cerr << "testGraphCache: cell read back differently" << std::endl; 
+      nfailed++; 
+    }
+  if(readsummary.natoms != summary.natoms || readsummary.nbonds != summary.nbonds || readsummary.nrings != summary.nrings 
+     || readsummary.average != summary.average || readsummary.mu2 != summary.mu2 
+     || readsummary.bndlength != summary.bndlength || readsummary.lewis != summary.lewis)
+    {
+      std::cerr << "testGraphCache: statistics read back differently" << std::endl; 
+      nfailed++; 
+    }
+  removeDirectory(dir); 
+  return nfailed; 
+}//testGraphCache()
+
+/*
+  testBootstrapCrystal, a nearly crystalline sample of 40 rings of size 6,
+  one of 5 and one of 7. Many resamples draw only hexagons and do not
+  determine the line, they must be left out of the interval, not count
+  as a slope and intercept of 0. Two points on 50 resamples leave too
+  few that determine the line for an interval. 
+  @return number of failed checks  
+*/
+int testBootstrapCrystal()
+{
+  //y = x - 3, spread about the hexagons 
+  std::vector<FitPoint> points; 
+  for(int i = 0; i < 40; i++)
+    {
+      FitPoint p; 
+      p.x = 6; 
+      p.y = 3 + 0.1*(i % 5 - 2); 
+      points.push_back(p); 
+    }
+  FitPoint p; 
+  p.x = 5; p.y = 2; 
+  points.push_back(p); 
+  p.x = 7; p.y = 4; 
+  points.push_back(p); 
+
+  int nfailed = 0; 
+  LinearFit fit; 
+  bootstrapFit(points,false,1000,1,7,fit); 
+  if(!fit.fitted || !fit.interval || fit.nvalid == 1000 || fit.nvalid < 500 
+     || fit.slopelow < 0.5 || fit.slopelow > fit.slope || fit.slopehigh < fit.slope 
+     || fit.intercepthigh > -1 || fit.interceptlow > fit.intercept || fit.intercepthigh < fit.intercept)
+    {
+      std::cerr << "testBootstrapCrystal: slope " << fit.slope << " [" << fit.slopelow << ", " << fit.slopehigh 
+		<< "] intercept " << fit.intercept << " [" << fit.interceptlow << ", " << fit.intercepthigh 
+		<< "] from " << fit.nvalid << " of 1000 resamples" << std::endl; 
+      nfailed++; 
+    }
+
+  points.resize(2); 
+  points[0].x = 5; 
+  points[1].x = 6; 
+  bootstrapFit(points,false,50,1,7,fit); 
+  if(!fit.fitted || fit.interval || fit.nvalid >= BOOTSTRAP_MIN_VALID)
+    {
+      std::cerr << "testBootstrapCrystal: interval from " << fit.nvalid << " of 50 resamples of two points" << std::endl; 
+      nfailed++; 
+    }
+  return nfailed; 
+}//testBootstrapCrystal()
+
+/*
+  runTests, runs all of the tests
+  @return number of failed checks 
+*/
+int runTests()
+{
+  int nfailed = 0; 
+  int n; 
+
+  n = testRinglessBatch(); 
+  std::cout << "testRinglessBatch " << (n ? "FAILED" : "passed") << std::endl; 
+  nfailed += n; 
+
+  n = testRingmax(); 
+  std::cout << "testRingmax " << (n ? "FAILED" : "passed") << std::endl; 
+  nfailed += n; 
+
+  n = testPutFloat(); 
+  std::cout << "testPutFloat " << (n ? "FAILED" : "passed") << std::endl; 
+  nfailed += n; 
+
+  n = testGraphCache(); 
+  std::cout << "testGraphCache " << (n ? "FAILED" : "passed") << std::endl; 
+  nfailed += n; 
+
+  n = testBootstrapCrystal(); 
+  std::cout << "testBootstrapCrystal " << (n ? "FAILED" : "passed") << std::endl; 
+  nfailed += n; 
+
+  std::cout << (nfailed ? "Tests failed" : "All tests passed") << std::endl; 
+  return nfailed; 
+}//runTests()
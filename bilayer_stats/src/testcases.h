@@ -4,3 +4,9 @@
 #include "vertex.h"
 
 void testSquare();
+int testRinglessBatch(); 
+int testRingmax(); 
+int testPutFloat(); 
+int testGraphCache(); 
+int testBootstrapCrystal(); 
+int runTests(); 
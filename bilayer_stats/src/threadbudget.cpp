@@ -0,0 +1,41 @@
+//threadbudget.cpp 
+#include <pthread.h>
+#include <unistd.h>
+
+#include "threadbudget.h"
+
+static pthread_mutex_t budgetLock = PTHREAD_MUTEX_INITIALIZER; 
+static int budgetFree = -1;   //cores not yet running a thread, -1 before the first call
+
+/*
+  threadsAcquire, takes helper threads from the budget
+  @param wanted, number of helper threads the caller could use 
+  @return number of helper threads granted, 0 to wanted 
+*/
+int threadsAcquire(int wanted)
+{
+  pthread_mutex_lock(&budgetLock); 
+  if(budgetFree < 0)
+    {
+      budgetFree = sysconf(_SC_NPROCESSORS_ONLN) - 1; 
+      if(budgetFree < 0)
+	budgetFree = 0; 
+    }
+  int granted = wanted < budgetFree ? wanted : budgetFree; 
+  if(granted < 0)
+    granted = 0; 
+  budgetFree -= granted; 
+  pthread_mutex_unlock(&budgetLock); 
+  return granted; 
+}//threadsAcquire()
+
+/*
+  threadsRelease, gives helper threads back to the budget once joined
+  @param n, number of helper threads granted by threadsAcquire 
+*/
+void threadsRelease(int n)
+{
+  pthread_mutex_lock(&budgetLock); 
+  budgetFree += n; 
+  pthread_mutex_unlock(&budgetLock); 
+}//threadsRelease()
@@ -0,0 +1,17 @@
+//threadbudget.h 
+#ifndef _THREADBUDGET_H
+#define _THREADBUDGET_H
+
+/*
+  Budget of the threads of the process, one per core. A thread is
+  counted while it runs analysis, the main thread from the start. Code
+  that splits its work over helper threads takes them from the budget
+  and gives them back when they are joined, so the batch pool, the
+  layers, the bootstrap and the renderer together do not run more
+  threads than there are cores. A caller that gets no helpers does the
+  work itself.
+ */
+int threadsAcquire(int wanted); 
+void threadsRelease(int n); 
+
+#endif
@@ -6,6 +6,7 @@
 #include <cstdio>
 
 #include "vertex.h"
+#include "cell.h"
 
 /*
   Contstructor for Vertex Objects
@@ -16,6 +17,7 @@ Vertex::Vertex()
   x = 0; 
   y = 0; 
   z = 0; 
+  layer = 0; 
 }//Vertex()
 
 Vertex::Vertex(int type,float xIn, float yIn, float zIn)
@@ -24,6 +26,7 @@ Vertex::Vertex(int type,float xIn, float yIn, float zIn)
   x = xIn; 
   y = yIn;
   z = zIn; 
+  layer = 0; 
   
 }//Vertex()
 
@@ -33,10 +36,13 @@ Vertex::Vertex(Vertex &v)
   y = v.y;
   z = v.z; 
   index = v.index;
+  layer = v.layer; 
   edges.clear(); 
 
   for(unsigned int i = 0; i<v.edges.size(); i++)
     edges.push_back(v.edges[i]);
+  images = v.images; 
+  bridges = v.bridges; 
 
   for(unsigned int i = 0; i<rings.size(); i++)
     rings[i].clear(); 
@@ -56,6 +62,18 @@ Vertex::Vertex(Vertex &v)
   @param: Pointer to Vertex object 
  */
 void Vertex::AddEdge(Vertex* edge)
+{
+  AddEdge(edge, Image()); 
+}
+
+/*
+  Creates an Edge to a periodic image of a vertex 
+  @param: Pointer to Vertex object 
+  @param: image, lattice vectors to add to the vertex 
+  @param: bridge, atom between the two vertices when the edge replaces
+  two bonds, NULL for a direct bond 
+ */
+void Vertex::AddEdge(Vertex* edge, Image image, Vertex* bridge)
 {
   for(unsigned int i = 0; i < edges.size(); i++)
     {
@@ -64,7 +82,60 @@ void Vertex::AddEdge(Vertex* edge)
     }
 
   edges.push_back(edge); 
-  edge->AddEdge((Vertex*)this);
+  images.push_back(image); 
+  bridges.push_back(bridge); 
+  edge->AddEdge((Vertex*)this, -image, bridge);
+}
+
+/*
+  Creates an Edge to the nearest periodic image of a vertex
+  @param: Pointer to Vertex object 
+  @param: cell, periodic cell 
+ */
+void Vertex::AddPeriodicEdge(Vertex* edge, const Cell &cell)
+{
+  AddEdge(edge, MinimumImage(edge, cell)); 
+}
+
+/*
+  Nearest periodic image of a vertex
+  @param: Pointer to Vertex object 
+  @param: cell, periodic cell 
+  @return: lattice vectors to add to the vertex 
+ */
+Image Vertex::MinimumImage(Vertex* edge, const Cell &cell)
+{
+  return cellMinimumImage(cell, edge->x - x, edge->y - y, edge->z - z); 
+}
+
+/*
+  Position of an edge in the edge list 
+  @param: Pointer to Vertex object 
+  @return: index of the edge or -1 if not connected 
+ */
+int Vertex::EdgeIndex(Vertex* edge)
+{
+  for(unsigned int i = 0; i < edges.size(); i++)
+    {
+      if(edges[i] == edge)
+	return i; 
+    }
+  return -1; 
+}
+
+/*
+  Vector from the vertex to the bonded image of an edge 
+  @param: k, index of the edge 
+  @param: cell, periodic cell 
+  @param: dx, dy, dz bond vector 
+ */
+void Vertex::BondVector(int k, const Cell &cell, float &dx, float &dy, float &dz)
+{
+  float sx, sy, sz; 
+  cellShift(cell, images[k], sx, sy, sz); 
+  dx = edges[k]->x + sx - x; 
+  dy = edges[k]->y + sy - y; 
+  dz = edges[k]->z + sz - z; 
 }
 
 /*
@@ -79,6 +150,8 @@ int Vertex::RemoveEdge(Vertex* edge)
 	{
 	  Vertex* pointerToNeighbor = edges[i];
           edges.erase(edges.begin() + i);
+	  images.erase(images.begin() + i);
+	  bridges.erase(bridges.begin() + i);
           pointerToNeighbor->RemoveSingleEdge((Vertex*)this);
           return 0;
   
@@ -98,6 +171,8 @@ int Vertex::RemoveSingleEdge(Vertex* edge)
       if(edges[i] == edge)
         {
           edges.erase(edges.begin() + i);
+	  images.erase(images.begin() + i);
+	  bridges.erase(bridges.begin() + i);
           return 0;
         }
     }
@@ -7,6 +7,24 @@
 
 using namespace std; 
 
+/*
+  Periodic image of an edge, the number of lattice vectors to add to
+  the neighbor to get the image bonded to the vertex 
+ */
+struct Image
+{
+  int nx; 
+  int ny; 
+  int nz; 
+  Image() : nx(0), ny(0), nz(0) {}
+  Image(int xIn, int yIn, int zIn=0) : nx(xIn), ny(yIn), nz(zIn) {}
+  Image operator-() const { return Image(-nx,-ny,-nz); }
+  Image operator+(const Image &o) const { return Image(nx+o.nx,ny+o.ny,nz+o.nz); }
+  bool wraps() const { return nx != 0 || ny != 0 || nz != 0; }
+};
+
+struct Cell; 
+
 class Vertex
 {
   
@@ -18,13 +36,21 @@ class Vertex
   int index;
   string type; 
   int atomno; 
+  int layer;     //sheet of a bilayer, rings only follow edges within a layer 
   Vertex();
   std::vector<Vertex*> edges; 
+  std::vector<Image> images; 
+  std::vector<Vertex*> bridges;   //bridging atom of each edge of a contracted graph, or NULL 
   std::vector<vector<Vertex*> > rings;
   Vertex(int type,float xIn, float yIn, float zIn);
   Vertex(Vertex &v);
 
   void AddEdge(Vertex* edge);
+  void AddEdge(Vertex* edge, Image image, Vertex* bridge=NULL);
+  void AddPeriodicEdge(Vertex* edge, const Cell &cell);
+  Image MinimumImage(Vertex* edge, const Cell &cell);
+  int EdgeIndex(Vertex* edge);
+  void BondVector(int k, const Cell &cell, float &dx, float &dy, float &dz);
   int RemoveEdge(double xVert, double yVert);
   int RemoveEdge(Vertex* edge);
   int RemoveSingleEdge(Vertex* edge);